@@ -0,0 +1,133 @@
+#pragma once
+
+#include "IPAddress.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <list>
+#include <unordered_map>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Non-blocking reverse-DNS lookups behind a worker pool and a TTL cache
+ * Resolve() answers from a sharded LRU cache, or reports Pending and queues
+ * the address for a bounded pool of worker threads, so callers on the
+ * monitoring loop never wait on the network. A request for an address that
+ * is already queued or being looked up joins that lookup instead of adding
+ * another. Names found are cached for positiveTtl, failures for the shorter
+ * negativeTtl.
+ *
+ * The lookup itself is pluggable: getnameinfo by default, or a hosts file or
+ * any stub function, which keeps tests and offline runs off the network.
+ * Workers start with the first queued lookup; destruction waits for lookups
+ * already running.
+ */
+class DnsResolver {
+public:
+    enum class Status : uint8_t {
+        Resolved,
+        NotFound,
+        Pending     // queued or running; ask again later
+    };
+
+    struct Result {
+        Status status;
+        std::string hostname;  // set when Resolved
+    };
+
+    // Blocking lookup, run on a worker; false when the address has no name
+    using LookupFunction = std::function<bool(const IPAddress& address, std::string& hostname)>;
+
+    struct Config {
+        size_t workers = 4;
+        size_t cacheCapacity = 65536;            // entries across all shards
+        size_t maxQueued = 4096;                 // lookups beyond this are dropped and retried later
+        std::chrono::seconds positiveTtl{3600};
+        std::chrono::seconds negativeTtl{300};
+    };
+
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;       // lookups queued
+        uint64_t coalesced;    // requests that joined a lookup in flight
+        uint64_t lookups;      // lookups completed
+        uint64_t dropped;      // not queued because the queue was full
+        size_t cached;
+    };
+
+    DnsResolver();
+    explicit DnsResolver(const Config& config, LookupFunction lookup = SystemLookup);
+    ~DnsResolver();
+
+    DnsResolver(const DnsResolver&) = delete;
+    DnsResolver& operator=(const DnsResolver&) = delete;
+
+    Result Resolve(const IPAddress& address);
+    // Waits until no lookup is queued or running; false on timeout
+    bool WaitIdle(std::chrono::milliseconds timeout);
+    Stats GetStats() const;
+
+    // getnameinfo with NI_NAMEREQD
+    static bool SystemLookup(const IPAddress& address, std::string& hostname);
+    // "address name [aliases]" lines, first name per address; an empty
+    // function when the file cannot be read
+    static LookupFunction HostsFileLookup(const std::string& path);
+
+    // Process-wide resolver used by Utils::GetHostname, created with the
+    // defaults on first use unless one was installed
+    static std::shared_ptr<DnsResolver> Global();
+    static void SetGlobal(std::shared_ptr<DnsResolver> resolver);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        IPAddress address;
+        Status status;
+        std::string hostname;
+        Clock::time_point expires;   // unused while Pending
+    };
+
+    // Most recently used entries first
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> entries;
+        std::unordered_map<IPAddress, std::list<Entry>::iterator> index;
+    };
+
+    static constexpr size_t kShardCount = 16;
+
+    Config config_;
+    LookupFunction lookup_;
+    size_t shardCapacity_;
+    Shard shards_[kShardCount];
+
+    std::mutex queueMutex_;
+    std::condition_variable queueReady_;
+    std::condition_variable queueIdle_;
+    std::deque<IPAddress> queue_;
+    size_t running_;
+    bool stopping_;
+    std::vector<std::thread> workers_;
+
+    std::atomic<uint64_t> hits_;
+    std::atomic<uint64_t> misses_;
+    std::atomic<uint64_t> coalesced_;
+    std::atomic<uint64_t> lookups_;
+    std::atomic<uint64_t> dropped_;
+
+    Shard& ShardFor(const IPAddress& address);
+    void Evict(Shard& shard);
+    void Store(const IPAddress& address, Status status, std::string hostname);
+    void Forget(const IPAddress& address);
+    bool Enqueue(const IPAddress& address);
+    void WorkerLoop();
+};
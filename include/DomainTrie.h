@@ -0,0 +1,78 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Domain blocklist matching a name against blocked domains and their parents
+ * Rules are stored label by label from the right ("www.example.com" becomes
+ * com -> example -> www) in a trie whose nodes are bare integers: every edge
+ * lives in one open-addressing table keyed by (parent node, label id), and
+ * each distinct label is interned once however many rules share it. A lookup
+ * walks the name's labels right to left and stops at the first blocked
+ * parent, so "is this name or any parent domain blocked" is a single pass
+ * with no allocation.
+ *
+ * "example.com" blocks the domain and all of its subdomains; "*.example.com"
+ * blocks only the subdomains. Matching ignores ASCII case and a trailing dot.
+ */
+class DomainTrie {
+public:
+    static constexpr size_t kMaxNameLength = 253;
+    static constexpr size_t kMaxLabelLength = 63;
+
+    DomainTrie();
+
+    // Insert/Remove return false when nothing changed or the rule is invalid.
+    // Remove keeps the rule's nodes, so reinserting it is cheap.
+    bool Insert(std::string_view rule);
+    bool Remove(std::string_view rule);
+    void Clear();
+
+    // On a match, `matched` receives the blocked domain as a suffix of `name`
+    bool Match(std::string_view name, std::string_view* matched = nullptr) const;
+    bool Contains(std::string_view name) const { return Match(name); }
+
+    size_t Size() const { return ruleCount_; }
+    bool Empty() const { return ruleCount_ == 0; }
+    std::vector<std::string> GetRules() const;  // wildcard rules keep their "*." prefix
+    size_t GetMemoryUsage() const;
+
+private:
+    // A node is identified by the slot of its incoming edge (slot + 1; the
+    // root is 0), so an edge only needs its key. The low two bits of `label`
+    // hold the node's rule flags.
+    struct Edge {
+        uint32_t parent;  // kEmpty marks a free slot
+        uint32_t label;   // label id << 2 | flags
+    };
+
+    enum NodeFlags : uint32_t {
+        kBlocked = 1,     // the domain and its subdomains
+        kWildcard = 2,    // subdomains only
+        kFlagMask = 3
+    };
+
+    static constexpr uint32_t kEmpty = 0xFFFFFFFFu;
+    static constexpr size_t kLabelPageSize = 65536;
+
+    std::vector<Edge> edges_;         // power-of-two size, linear probing
+    size_t edgeCount_;
+    std::vector<std::string> labelPages_;  // interned labels, each a length byte then the text
+    std::vector<uint32_t> labelSlots_;     // label id + 1, 0 = empty; id = page << 16 | offset
+    size_t labelCount_;
+    size_t ruleCount_;
+
+    static bool ParseRule(std::string_view rule, std::string_view& name, uint32_t& flag);
+    std::string_view Label(uint32_t id) const;
+    uint32_t FindLabel(std::string_view label, uint64_t hash) const;
+    uint32_t InternLabel(std::string_view label);
+    size_t FindEdge(uint32_t parent, uint32_t label) const;  // slot, or SIZE_MAX
+    size_t AddEdge(uint32_t parent, uint32_t label);
+    size_t FindRule(std::string_view name) const;
+    void GrowLabels();
+    void GrowEdges();
+};
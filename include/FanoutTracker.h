@@ -0,0 +1,44 @@
+#pragma once
+
+#include "IPAddress.h"
+#include "HyperLogLog.h"
+#include <unordered_map>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Per-source estimate of distinct (destination host, destination port) targets
+ * A port scan touches many targets, not just many connections. Each source
+ * keeps a sparse HyperLogLog, so 100k quiet sources fit in a few MB while
+ * active scanners upgrade to 1 KB dense sketches. Sources idle for longer
+ * than the timeout are dropped, and the table is capped at maxSources.
+ */
+class FanoutTracker {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit FanoutTracker(size_t maxSources = 100000,
+                           std::chrono::seconds idleTimeout = std::chrono::hours(1));
+
+    void Add(const IPAddress& source, const IPAddress& target, uint16_t targetPort,
+             Clock::time_point now = Clock::now());
+    double Estimate(const IPAddress& source) const;
+    void Clear();
+
+    size_t GetSourceCount() const { return sources_.size(); }
+    size_t GetMemoryUsage() const;
+
+private:
+    struct Entry {
+        HyperLogLog distinctTargets;
+        Clock::time_point lastSeen;
+    };
+
+    std::unordered_map<IPAddress, Entry> sources_;
+    size_t maxSources_;
+    std::chrono::seconds idleTimeout_;
+    Clock::time_point lastSweep_;
+
+    void Evict(Clock::time_point now);
+};
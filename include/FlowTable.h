@@ -0,0 +1,123 @@
+#pragma once
+
+#include "IPAddress.h"
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Bounded 5-tuple flow table with idle expiry
+ * Flows live in fixed-size chunks (stable addresses, no rehash copies) and
+ * are found through a robin-hood open-addressing index of 8-byte entries,
+ * so a lookup usually touches one index cache line and one flow. Idle
+ * flows are expired by a 256-slot, one-second timer wheel; updates never
+ * touch the wheel, a flow is only re-filed when its slot comes due.
+ *
+ * A flow is keyed in the direction it was first seen (initiator first);
+ * packets in the other direction find it through a reversed lookup.
+ */
+class FlowTable {
+public:
+    using Clock = std::chrono::system_clock;
+
+    struct Key {
+        IPAddress source;
+        IPAddress destination;
+        uint16_t sourcePort;
+        uint16_t destinationPort;
+        uint8_t protocol;  // IPPROTO_* value
+
+        static Key Make(const IPAddress& source, uint16_t sourcePort,
+                        const IPAddress& destination, uint16_t destinationPort, uint8_t protocol);
+        Key Reversed() const;
+        uint64_t Hash() const;
+        bool operator==(const Key& other) const;
+    };
+
+    struct Flow {
+        Key key;
+        uint64_t bytes[2];      // [0] initiator -> responder, [1] reverse
+        uint32_t packets[2];
+        uint32_t firstSeen;     // seconds since the Unix epoch
+        uint32_t lastSeen;
+        uint8_t state;          // caller-defined (socket state for scanned flows)
+        uint8_t tcpFlags;       // union of all TCP flags seen
+        uint8_t payloadTag;     // caller-defined, identifies what produced payloadState
+        uint32_t timerNext;     // wheel / free list link (id + 1, 0 = end)
+        uint32_t payloadState[2];  // caller-defined per-direction payload scanner state
+    };
+
+    using ExpireCallback = std::function<void(const Flow&)>;
+
+    explicit FlowTable(size_t maxFlows = 10000000,
+                       std::chrono::seconds idleTimeout = std::chrono::seconds(120));
+
+    // Finds the flow in either direction or creates it keyed as given.
+    // Returns nullptr only when the table is full. `reverse` is set when the
+    // update ran against the flow's responder -> initiator direction.
+    Flow* Update(const Key& key, uint32_t bytes, uint8_t tcpFlags, Clock::time_point now,
+                 bool& created, bool* reverse = nullptr);
+    const Flow* Find(const Key& key) const;
+
+    // Expires flows idle past their timeout; returns how many were removed
+    size_t Expire(Clock::time_point now, const ExpireCallback& onExpired = nullptr);
+    void Clear();
+
+    size_t Size() const { return size_; }
+    size_t GetMaxFlows() const { return maxFlows_; }
+    uint64_t GetTotalCreated() const { return totalCreated_; }
+    uint64_t GetDropped() const { return dropped_; }
+    size_t GetMemoryUsage() const;
+
+    template <typename F>
+    void ForEach(F&& f) const {
+        for (size_t i = 0; i < index_.size(); ++i) {
+            if (index_[i].flow) f(static_cast<const Flow&>(FlowAt(index_[i].flow - 1)));
+        }
+    }
+
+private:
+    static constexpr size_t kChunkBits = 16;
+    static constexpr size_t kChunkSize = size_t(1) << kChunkBits;
+    static constexpr size_t kWheelSlots = 256;
+
+    struct IndexEntry {
+        uint32_t flow;  // id + 1, 0 = empty
+        uint32_t hash;  // low 32 bits of the key hash
+    };
+
+    size_t maxFlows_;
+    uint32_t idleTimeout_;
+
+    std::vector<IndexEntry> index_;  // power-of-two sized
+    size_t mask_;
+    size_t size_;
+
+    std::vector<std::unique_ptr<Flow[]>> chunks_;
+    uint32_t allocated_;  // ids handed out so far (high-water mark)
+    uint32_t freeList_;   // id + 1 of the first recycled flow
+
+    uint32_t wheel_[kWheelSlots];
+    uint32_t wheelTick_;  // last second processed, 0 = not started
+
+    uint64_t totalCreated_;
+    uint64_t dropped_;
+
+    Flow& FlowAt(uint32_t id) const { return chunks_[id >> kChunkBits][id & (kChunkSize - 1)]; }
+    uint32_t Deadline(const Flow& flow) const { return flow.lastSeen + idleTimeout_; }
+
+    size_t FindSlot(const Key& key, uint32_t hash) const;  // index_.size() if absent
+    void InsertIndex(uint32_t id, uint32_t hash);
+    void EraseIndex(size_t slot);
+    void Grow();
+
+    uint32_t AllocateFlow();
+    void Schedule(uint32_t id);
+    size_t ProcessSlot(size_t slot, uint32_t now, const ExpireCallback& onExpired);
+    void Remove(uint32_t id);
+
+    static uint32_t ToSeconds(Clock::time_point time);
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+
+/**
+ * Packed 16-byte IP address (IPv4 stored as IPv4-mapped IPv6)
+ * Trivially copyable, hashable and comparable without touching the heap
+ */
+class IPAddress {
+public:
+    // Longest text form, e.g. "ffff:ffff:ffff:ffff:ffff:ffff:255.255.255.255"
+    static constexpr size_t kMaxTextLength = 45;
+
+    IPAddress() : words_{0, 0} {}
+
+    static IPAddress FromIPv4(uint32_t hostOrder);
+    static IPAddress FromIPv4Bytes(const uint8_t* networkOrder);
+    static IPAddress FromIPv6Bytes(const uint8_t* networkOrder);
+
+    // Special-purpose ranges from the IANA registries for both families;
+    // IPv4-mapped IPv6 addresses classify as their IPv4 address
+    enum class Scope : uint8_t {
+        Global,
+        Unspecified,    // 0.0.0.0, ::
+        Loopback,       // 127.0.0.0/8, ::1
+        Private,        // 10/8, 172.16/12, 192.168/16, fc00::/7 (unique local)
+        LinkLocal,      // 169.254/16, fe80::/10
+        SharedCgnat,    // 100.64/10
+        Multicast,      // 224/4, ff00::/8
+        Documentation,  // 192.0.2/24, 198.51.100/24, 203.0.113/24, 2001:db8::/32, 3fff::/20
+        Broadcast,      // 255.255.255.255
+        Reserved        // rest of 0/8, 192.0.0/24, 198.18/15, 240/4, fec0::/10, other ::/8
+    };
+
+    // Parses dotted-quad IPv4 or RFC 4291 IPv6 text; false on malformed input
+    static bool Parse(std::string_view text, IPAddress& out);
+    // Family-specific forms; ParseIPv6 also takes embedded IPv4 ("::ffff:1.2.3.4")
+    static bool ParseIPv4(std::string_view text, IPAddress& out);
+    static bool ParseIPv6(std::string_view text, IPAddress& out);
+    // Convenience form: returns the unspecified address on malformed input
+    static IPAddress FromString(std::string_view text);
+
+    bool IsIPv4() const;
+    bool IsUnspecified() const { return words_[0] == 0 && words_[1] == 0; }
+    uint32_t ToIPv4() const;  // host order; only meaningful when IsIPv4()
+    Scope Classify() const;
+    static const char* GetScopeName(Scope scope);
+    const uint8_t* Bytes() const { return reinterpret_cast<const uint8_t*>(words_); }
+
+    // Writes the text form without a terminator and returns its length
+    size_t Format(char* out) const;
+    std::string ToString() const;
+
+    uint64_t Hash() const {
+        // Two 64-bit loads folded with a multiply-xorshift finalizer
+        uint64_t h = words_[0] * 0x9E3779B97F4A7C15ull ^ words_[1];
+        h ^= h >> 32;
+        h *= 0xD6E8FEB86659FD93ull;
+        h ^= h >> 32;
+        return h;
+    }
+
+    bool operator==(const IPAddress& other) const {
+        return words_[0] == other.words_[0] && words_[1] == other.words_[1];
+    }
+    bool operator!=(const IPAddress& other) const { return !(*this == other); }
+    bool operator<(const IPAddress& other) const {
+        return std::memcmp(words_, other.words_, sizeof(words_)) < 0;
+    }
+
+private:
+    uint64_t words_[2];  // raw network-order bytes; compared with memcmp for ordering
+
+    uint8_t* MutableBytes() { return reinterpret_cast<uint8_t*>(words_); }
+};
+
+struct IPAddressHash {
+    size_t operator()(const IPAddress& address) const noexcept {
+        return static_cast<size_t>(address.Hash());
+    }
+};
+
+namespace std {
+template <>
+struct hash<IPAddress> : IPAddressHash {};
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "IPAddress.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+/**
+ * Longest-prefix-match set of IPv4/IPv6 CIDR ranges
+ * Each family uses a direct first-level table indexed by the top address
+ * bits (20 for IPv4, 16 for IPv6), followed by a path-compressed binary
+ * trie stored in a flat node array. A lookup is one table read plus a few
+ * node hops.
+ */
+class IPPrefixSet {
+public:
+    struct Prefix {
+        IPAddress address;
+        int length;  // relative to the family: 0-32 for IPv4, 0-128 for IPv6
+
+        std::string ToString() const;
+    };
+
+    IPPrefixSet();
+    ~IPPrefixSet();
+    IPPrefixSet(IPPrefixSet&&) noexcept;
+    IPPrefixSet& operator=(IPPrefixSet&&) noexcept;
+
+    // Parses "10.0.0.0/8", "2001:db8::/32" or a bare address (full-length prefix)
+    static bool ParseCidr(std::string_view text, IPAddress& address, int& length);
+
+    // Insert/Remove return false when nothing changed or the prefix is invalid
+    bool Insert(const IPAddress& address, int length);
+    bool Insert(std::string_view cidr);
+    bool Remove(const IPAddress& address, int length);
+    bool Remove(std::string_view cidr);
+    void Clear();
+
+    bool Contains(const IPAddress& address) const { return LongestMatch(address) >= 0; }
+    // Length of the longest stored prefix covering the address, or -1
+    int LongestMatch(const IPAddress& address) const;
+
+    size_t Size() const;
+    bool Empty() const { return Size() == 0; }
+    std::vector<Prefix> GetPrefixes() const;
+
+private:
+    template <typename Key>
+    class Trie;
+
+    struct Key128 {
+        uint64_t hi;
+        uint64_t lo;
+    };
+
+    std::unique_ptr<Trie<uint32_t>> v4_;
+    std::unique_ptr<Trie<Key128>> v6_;
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "NetworkMonitor.h"
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Linux socket table reader for /proc/net/{tcp,tcp6,udp,udp6}
+ * Parses rows in place from a single reusable buffer and decodes them
+ * directly into NetworkMonitor::NetworkConnection records
+ */
+class LinuxConnectionTable {
+public:
+    enum class Table {
+        Tcp,
+        Tcp6,
+        Udp,
+        Udp6
+    };
+
+    // Bit (1 << st) per kernel socket state; UDP uses 1 (connected) and 7 (unconnected)
+    static constexpr uint32_t kAllStates = 0xFFFFFFFFu;
+
+    explicit LinuxConnectionTable(const std::string& procRoot = "/proc");
+
+    // Reads one table and writes its rows into `out` starting at `offset`.
+    // Existing elements are overwritten in place so their storage is reused;
+    // the vector only grows when the table has more rows than ever before.
+    // Returns the number of rows written.
+    size_t Read(Table table, std::vector<NetworkMonitor::NetworkConnection>& out, size_t offset,
+                uint32_t stateMask = kAllStates);
+
+    // Parses an already loaded table image (same contract as Read)
+    static size_t Parse(Table table, const char* data, size_t length,
+                        std::vector<NetworkMonitor::NetworkConnection>& out, size_t offset,
+                        std::chrono::system_clock::time_point timestamp,
+                        uint32_t stateMask = kAllStates);
+
+    // Fills one record from binary socket fields (addresses in network byte order).
+    // Shared with the netlink backend so both produce identical records.
+    static void DecodeRow(NetworkMonitor::NetworkConnection& conn, Table table,
+                          const uint8_t* local, int localPort,
+                          const uint8_t* remote, int remotePort, unsigned state,
+                          std::chrono::system_clock::time_point timestamp);
+
+    static const char* GetTablePath(Table table);
+    static bool IsIPv6(Table table) { return table == Table::Tcp6 || table == Table::Udp6; }
+    static bool IsTcp(Table table) { return table == Table::Tcp || table == Table::Tcp6; }
+
+private:
+    std::string procRoot_;
+    std::string tablePaths_[4];
+    std::vector<char> buffer_;
+
+    bool LoadFile(const std::string& path, size_t& length);
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Linux process table built from /proc/<pid>/{stat,status,cmdline,exe}
+ * Scan() walks /proc with openat() relative to a directory descriptor and
+ * reports what changed since the previous scan: processes spawned, exited or
+ * changed (exec, reparenting). Processes are keyed on pid and start time, so
+ * a recycled pid shows up as an exit followed by a spawn.
+ *
+ * Known processes are mostly confirmed with one fstatat() of their /proc
+ * directory: a recycled pid gets a new inode, and a setuid changes the
+ * owner. Their stat file is re-read while they are young (fork is usually
+ * followed by exec), when their parent exited (reparenting), and otherwise
+ * every kRefreshScans scans, which bounds how late an exec in a long-lived
+ * process or a change in its CPU and memory figures is seen. status,
+ * cmdline and exe are only read for new processes and for ones whose command
+ * name or owner changed. Large tables are split across threads. On other
+ * platforms Scan() fails.
+ */
+class LinuxProcessTable {
+public:
+    struct Process {
+        int pid;
+        int ppid;
+        uint32_t uid;          // real uid
+        uint64_t startTime;    // clock ticks after boot
+        char state;            // R, S, D, Z, ...
+        std::string name;      // comm, at most 15 characters
+        std::string exe;       // empty for kernel threads and when not permitted
+        std::string cmdline;   // arguments joined by spaces, truncated to kMaxCmdline
+        uint64_t cpuTicks;     // utime + stime
+        uint64_t rssKb;
+    };
+
+    enum ChangedField : uint32_t {
+        kNameChanged = 1,
+        kParentChanged = 2,
+        kExeChanged = 4,
+        kCmdlineChanged = 8,
+        kUserChanged = 16
+    };
+
+    struct Change {
+        enum class Type : uint8_t {
+            Spawned,
+            Exited,
+            Changed
+        };
+        Type type;
+        uint32_t fields;       // ChangedField bits for Changed
+        Process process;       // the new state; the last known one for Exited
+    };
+
+    static constexpr size_t kMaxCmdline = 4096;
+    static constexpr uint64_t kYoungScans = 3;      // scans after a spawn with stat re-read every time
+    static constexpr uint64_t kRefreshScans = 4;
+
+    // threads = 0 picks one per core, up to 8
+    explicit LinuxProcessTable(const std::string& procRoot = "/proc", size_t threads = 0);
+    ~LinuxProcessTable();
+
+    LinuxProcessTable(const LinuxProcessTable&) = delete;
+    LinuxProcessTable& operator=(const LinuxProcessTable&) = delete;
+
+    // Appends the differences since the previous scan to `changes`; the
+    // first scan reports every process as spawned. False when procRoot
+    // cannot be read, leaving the table as it was.
+    bool Scan(std::vector<Change>& changes);
+
+    std::vector<Process> GetProcesses() const;
+    bool GetProcess(int pid, Process& process) const;
+    size_t Size() const { return table_.size(); }
+
+    static bool ParseStat(const char* data, size_t length, Process& process);
+    static const char* GetChangeTypeName(Change::Type type);
+
+private:
+    struct Entry {
+        Process process;
+        uint64_t seen;         // scan generation
+        uint64_t born;         // generation of the spawn
+        uint64_t inode;        // of /proc/<pid>
+        uint32_t owner;        // owner of /proc/<pid>: the effective uid
+    };
+
+    // One per pid listed in the directory, reused across scans
+    struct Sample {
+        int pid;
+        bool alive;            // the /proc entry (and stat, when read) could be read
+        bool statRead;         // false: confirmed unchanged from the directory alone
+        bool full;             // status, cmdline and exe were read too
+        uint64_t inode;
+        uint32_t owner;
+        Process process;
+    };
+
+    std::string procRoot_;
+    int procFd_;
+    size_t threads_;
+    long pageKb_;
+
+    std::unordered_map<int, Entry> table_;
+    std::vector<Sample> samples_;     // only grows, so the strings keep their storage
+    size_t sampleCount_;
+    uint64_t generation_;
+    std::vector<int> exitedPids_;     // sorted; exits seen by the previous scan
+
+    bool ListPids();
+    void ReadRange(size_t begin, size_t end);
+    bool ReadSample(Sample& sample, std::vector<char>& buffer) const;
+    bool NeedsStat(const Entry& entry) const;
+    void Merge(std::vector<Change>& changes);
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Linux CPU, memory and load collector for /proc/stat, /proc/meminfo and /proc/loadavg
+ * The three files stay open and each sample re-reads them from offset 0 with
+ * pread into one reusable buffer, parsing in place. Per-CPU state lives in
+ * vectors that only change size when CPUs come or go, so steady-state
+ * sampling neither opens files nor allocates.
+ *
+ * CPU usage is the delta between two successive ReadCpu() calls; the first
+ * call only primes the counters. On other platforms every read fails.
+ */
+class LinuxSystemStats {
+public:
+    // Cumulative jiffies from one "cpu" line
+    struct CpuTimes {
+        uint64_t user;
+        uint64_t nice;
+        uint64_t system;
+        uint64_t idle;
+        uint64_t iowait;
+        uint64_t irq;
+        uint64_t softirq;
+        uint64_t steal;
+    };
+
+    // Percentages of the interval between two samples
+    struct CpuUsage {
+        double busy;      // everything but idle and iowait
+        double user;      // user + nice
+        double system;    // system + irq + softirq
+        double iowait;
+        double steal;
+    };
+
+    struct MemoryInfo {
+        uint64_t totalKb;
+        uint64_t freeKb;
+        uint64_t availableKb;   // estimated from free + buffers + cached on kernels without MemAvailable
+        uint64_t buffersKb;
+        uint64_t cachedKb;
+        uint64_t swapTotalKb;
+        uint64_t swapFreeKb;
+
+        double UsedPercent() const;
+    };
+
+    struct LoadAverage {
+        double one;
+        double five;
+        double fifteen;
+        uint32_t runnable;
+        uint32_t total;
+    };
+
+    explicit LinuxSystemStats(const std::string& procRoot = "/proc");
+    ~LinuxSystemStats();
+
+    LinuxSystemStats(const LinuxSystemStats&) = delete;
+    LinuxSystemStats& operator=(const LinuxSystemStats&) = delete;
+
+    // Each returns false when the file cannot be read or parsed, leaving the
+    // previous values in place
+    bool ReadCpu();
+    bool ReadMemory();
+    bool ReadLoad();
+    bool Sample();   // all three
+
+    // Valid once ReadCpu() has succeeded twice
+    bool HasCpuUsage() const { return cpuReads_ >= 2; }
+    const CpuUsage& GetCpuUsage() const { return totalUsage_; }
+    const std::vector<CpuUsage>& GetPerCpuUsage() const { return cpuUsage_; }
+    const MemoryInfo& GetMemory() const { return memory_; }
+    const LoadAverage& GetLoad() const { return load_; }
+
+    // Parsers for an already loaded file image. ParseStat overwrites `cpus`
+    // in place and only resizes it when the number of CPU lines changes.
+    static bool ParseStat(const char* data, size_t length, CpuTimes& total, std::vector<CpuTimes>& cpus);
+    static bool ParseMeminfo(const char* data, size_t length, MemoryInfo& memory);
+    static bool ParseLoadavg(const char* data, size_t length, LoadAverage& load);
+    static CpuUsage Delta(const CpuTimes& previous, const CpuTimes& current);
+
+private:
+    enum File {
+        kStat,
+        kMeminfo,
+        kLoadavg,
+        kFileCount
+    };
+
+    std::string paths_[kFileCount];
+    int fds_[kFileCount];
+    std::vector<char> buffer_;
+
+    CpuTimes previousTotal_;
+    std::vector<CpuTimes> previousCpus_;
+    std::vector<CpuTimes> currentCpus_;
+    uint64_t cpuReads_;
+    CpuUsage totalUsage_;
+    std::vector<CpuUsage> cpuUsage_;
+    MemoryInfo memory_;
+    LoadAverage load_;
+
+    bool ReadFile(File file, size_t& length);
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Read-only memory mapping of a whole file
+ * Lets large inputs (captures, databases) be parsed in place without
+ * read() copies; the kernel pages data in on demand.
+ */
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // `sequential` hints the kernel to read ahead aggressively
+    bool Open(const std::string& path, bool sequential = false);
+    void Close();
+
+    bool IsOpen() const { return open_; }
+    const uint8_t* Data() const { return data_; }
+    size_t Size() const { return size_; }
+    const std::string& GetError() const { return error_; }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    bool open_;
+    std::string error_;
+#ifdef _WIN32
+    void* file_;
+    void* mapping_;
+#endif
+};
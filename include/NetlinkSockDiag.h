@@ -0,0 +1,36 @@
+#pragma once
+
+#include "LinuxConnectionTable.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * NETLINK_SOCK_DIAG (inet_diag) socket enumeration for Linux
+ * Dumps binary socket records in large batches and lets the kernel
+ * apply the state filter, avoiding the hex text round trip of /proc/net
+ */
+class NetlinkSockDiag {
+public:
+    NetlinkSockDiag();
+    ~NetlinkSockDiag();
+
+    NetlinkSockDiag(const NetlinkSockDiag&) = delete;
+    NetlinkSockDiag& operator=(const NetlinkSockDiag&) = delete;
+
+    // Opens the netlink socket; false when sock_diag is unavailable
+    bool Open();
+    void Close();
+    bool IsOpen() const { return socket_ >= 0; }
+
+    // Dumps one socket table with the same output contract as
+    // LinuxConnectionTable::Read. Returns false if the request or any
+    // reply failed, in which case `written` must be discarded.
+    bool Dump(LinuxConnectionTable::Table table, uint32_t stateMask,
+              std::vector<NetworkMonitor::NetworkConnection>& out, size_t offset, size_t& written);
+
+private:
+    int socket_;
+    uint32_t sequence_;
+    std::vector<char> buffer_;
+};
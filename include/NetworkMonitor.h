@@ -9,6 +9,25 @@
 #include <mutex>
 #include <set>
 #include <algorithm>
+#include <atomic>
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
+#include "IPAddress.h"
+#include "IPPrefixSet.h"
+#include "DomainTrie.h"
+#include "RateSketch.h"
+#include "FanoutTracker.h"
+#include "RingBuffer.h"
+#include "TimeSeries.h"
+#include "PacketDecoder.h"
+#include "FlowTable.h"
+#include "SynFloodDetector.h"
+
+class LinuxConnectionTable;
+class NetlinkSockDiag;
+class ThreatIntelDB;
+class SignatureEngine;
 
 /**
  * Network monitoring and analysis component
@@ -16,28 +35,39 @@
  */
 class NetworkMonitor {
 public:
+    enum class Protocol : uint8_t {
+        TCP,
+        UDP
+    };
+
     struct NetworkConnection {
-        std::string localAddress;
-        std::string remoteAddress;
-        int localPort;
-        int remotePort;
-        std::string protocol;
-        std::string state;
+        IPAddress localAddress;
+        IPAddress remoteAddress;
+        std::chrono::system_clock::time_point timestamp;
         std::string processName;
         int processId;
-        std::chrono::system_clock::time_point timestamp;
+        uint16_t localPort;
+        uint16_t remotePort;
+        Protocol protocol;
+        uint8_t state;      // kernel socket state (see ConnectionStateMask)
+
+        const char* GetProtocolName() const;
+        const char* GetStateName() const;
     };
 
     struct NetworkLog {
         int id;
         std::chrono::system_clock::time_point timestamp;
-        std::string sourceIp;
-        std::string destinationIp;
+        IPAddress sourceIp;         // unspecified for entries raised by the monitor itself
+        IPAddress destinationIp;
         std::string protocol;
         std::string threat;
         std::string status;
+        int severity;               // 1-5, same scale as SecurityMonitor events
     };
 
+    using ThreatCallback = std::function<void(const NetworkLog&)>;
+
     struct TrafficStats {
         uint64_t bytesReceived;
         uint64_t bytesSent;
@@ -48,7 +78,44 @@ public:
         std::chrono::system_clock::time_point timestamp;
     };
 
-    NetworkMonitor();
+    // Field order of TrafficSeries points
+    enum TrafficField : size_t {
+        FieldBytesReceived,
+        FieldBytesSent,
+        FieldPacketsReceived,
+        FieldPacketsSent,
+        FieldConnectionsActive,
+        FieldConnectionsTotal,
+        TrafficFieldCount
+    };
+    using TrafficSeries = TimeSeries<TrafficFieldCount>;
+
+    enum class ScanBackend {
+        Auto,       // netlink when available, otherwise /proc
+        ProcFs,
+        Netlink
+    };
+
+    // Kernel socket states usable in SetConnectionStateFilter (1 << state)
+    enum ConnectionStateMask : uint32_t {
+        StateEstablished = 1u << 1,
+        StateSynSent = 1u << 2,
+        StateSynRecv = 1u << 3,
+        StateTimeWait = 1u << 6,
+        StateUnconnected = 1u << 7,
+        StateCloseWait = 1u << 8,
+        StateListen = 1u << 10,
+        StateAll = 0xFFFFFFFFu
+    };
+
+    struct ScanTiming {
+        uint64_t scans;
+        uint32_t connections;
+        std::chrono::microseconds lastDuration;
+        std::chrono::microseconds averageDuration;
+    };
+
+    explicit NetworkMonitor(size_t logCapacity = 1024);
     ~NetworkMonitor();
 
     // Monitoring control
@@ -56,43 +123,134 @@ public:
     void StopMonitoring();
     bool IsMonitoring() const;
 
+    // Called for every new network log entry (detections, blocks, notices)
+    void SetThreatCallback(ThreatCallback callback);
+
     // Connection tracking
     std::vector<NetworkConnection> GetActiveConnections() const;
     std::vector<NetworkLog> GetNetworkLogs(int limit = 100) const;
+
+    // Connection scanner configuration
+    void SetScanBackend(ScanBackend backend);
+    ScanBackend GetScanBackend() const;
+    void SetConnectionStateFilter(uint32_t stateMask);
+    ScanTiming GetScanTiming(ScanBackend backend) const;
     
     // Traffic analysis
     TrafficStats GetCurrentStats() const;
-    std::vector<TrafficStats> GetStatsHistory(int minutes = 60) const;
+    size_t GetFlowCount() const;
+    size_t GetConnectionCount() const;  // sockets seen by the last connection scan
+    std::vector<TrafficStats> GetStatsHistory(int minutes = 60) const;  // bucket means
+    std::vector<TrafficSeries::Point> GetStatsSeries(int minutes = 60) const;  // min/max/sum per bucket
     
     // Threat detection
     std::vector<std::string> GetSuspiciousIPs() const;
     int GetThreatCount() const;
-    void BlockIP(const std::string& ip);
+    void BlockIP(const IPAddress& ip, int prefixLength = -1);  // -1 = single address
+    void BlockIP(const std::string& ip);                       // address or CIDR range
+    void UnblockIP(const IPAddress& ip, int prefixLength = -1);
     void UnblockIP(const std::string& ip);
+    bool IsIPBlocked(const IPAddress& ip) const;
+    bool IsIPBlocked(const std::string& ip) const;
     std::vector<std::string> GetBlockedIPs() const;
+    // "example.com" blocks the domain and its subdomains, "*.example.com"
+    // only the subdomains. Checked against resolved peer host names.
+    void BlockDomain(const std::string& domain);
+    void UnblockDomain(const std::string& domain);
+    bool IsDomainBlocked(const std::string& hostname) const;
+    std::vector<std::string> GetBlockedDomains() const;
+
+    // Offline packet input (e.g. pcap replay). Detector clocks follow the
+    // capture timestamps, so replaying faster than real time keeps rates intact.
+    void ProcessPacket(const PacketDecoder::Packet& packet, uint32_t wireLength,
+                       std::chrono::system_clock::time_point timestamp);
+    void FlushPacketStats();
 
     // Analysis methods
+    bool IsIPSuspicious(const IPAddress& ip) const;
     bool IsIPSuspicious(const std::string& ip) const;
+    std::string AnalyzeTrafficPattern(const IPAddress& ip) const;
     std::string AnalyzeTrafficPattern(const std::string& ip) const;
+
+    // Threat intelligence: IOC feed files (or directories of them) compiled
+    // into `databasePath`. UpdateThreatDatabase maps the compiled file,
+    // rebuilding it first when the feeds changed, and swaps it in while
+    // lookups continue on the previous one. The monitoring loop calls it
+    // periodically.
+    void SetThreatIntelSources(const std::vector<std::string>& feedPaths, const std::string& databasePath);
     void UpdateThreatDatabase();
+    std::shared_ptr<const ThreatIntelDB> GetThreatIntel() const;
+
+    // Payload signatures for ProcessPacket, matched per flow direction so a
+    // signature split across packets is still found. Takes a compiled engine;
+    // flows already in progress restart their partial matches on a swap.
+    void SetSignatureEngine(std::shared_ptr<const SignatureEngine> engine);
+    std::shared_ptr<const SignatureEngine> GetSignatureEngine() const;
 
 private:
     bool isMonitoring_;
     std::thread monitoringThread_;
-    int nextLogId_;
+    std::atomic<int> nextLogId_;
     
     mutable std::mutex connectionsMutex_;
     std::vector<NetworkConnection> connections_;
+    std::vector<NetworkConnection> scanBuffer_;  // filled by the scanner, swapped into connections_
+    size_t scanCount_;
+    std::unique_ptr<LinuxConnectionTable> connectionTable_;
+    std::unique_ptr<NetlinkSockDiag> sockDiag_;
+    std::atomic<ScanBackend> scanBackend_;
+    std::atomic<uint32_t> stateFilter_;
+    std::atomic<bool> netlinkUnavailable_;
+    ScanBackend lastScanBackend_;
+    ScanTiming procTiming_;
+    ScanTiming netlinkTiming_;
     
-    mutable std::mutex logsMutex_;
-    std::vector<NetworkLog> logs_;
+    RingBuffer<NetworkLog> logs_;
     
     mutable std::mutex statsMutex_;
-    std::vector<TrafficStats> statsHistory_;
+    TrafficSeries statsHistory_;
     
-    std::set<std::string> blockedIPs_;
-    std::set<std::string> suspiciousIPs_;
-    std::map<std::string, int> ipActivity_;
+    mutable std::mutex threatMutex_;
+    IPPrefixSet blockedIPs_;
+    IPPrefixSet suspiciousIPs_;
+    DomainTrie blockedDomains_;
+
+    // Per-source rate of newly observed connections, decayed over the sketch window
+    mutable std::mutex activityMutex_;
+    RateSketch ipActivity_;
+    // Per-source count of distinct (host, port) targets, for port-scan detection
+    FanoutTracker ipFanout_;
+    std::unordered_set<uint32_t> listeningPorts_;
+
+    // Flows from the connection scanner and packet sources, expired when idle.
+    // flowMutex_ also guards the offline packet counters; packetSecond_
+    // accumulates one capture second before it is folded into statsHistory_.
+    mutable std::mutex flowMutex_;
+    FlowTable flows_;
+    TrafficStats packetTotals_;
+    TrafficStats packetSecond_;
+    std::chrono::system_clock::time_point packetScanTime_;  // last half-open pass over packet flows
+
+    // SYN_RECV tracking per listener; guarded by flowMutex_ like the flows it reads
+    SynFloodDetector synFlood_;
+    std::vector<SynFloodDetector::Alert> synAlerts_;
+    std::vector<std::pair<size_t, bool>> newConnections_;  // scan rows to analyse, inbound flag
+
+    // Replaced whole via std::atomic_load/atomic_store; never modified in place
+    std::shared_ptr<const ThreatIntelDB> threatIntel_;
+    std::vector<std::string> threatFeeds_;  // guarded by threatMutex_
+    std::string threatDatabasePath_;
+    std::mutex threatIntelUpdateMutex_;     // one rebuild at a time
+    uint64_t threatIntelFailed_;            // fingerprint of the last failed build; guarded by the update mutex
+
+    // Guarded by flowMutex_. Flows tag their scanner states with the
+    // generation, so states left by an older engine are dropped.
+    std::shared_ptr<const SignatureEngine> signatures_;
+    uint8_t signatureGeneration_;
+
+    ThreatCallback threatCallback_;
+    bool packetClockSet_;
+    std::chrono::steady_clock::duration packetClockOffset_;
 
     // Monitoring implementation
     void MonitoringLoop();
@@ -104,14 +262,22 @@ private:
     void GetTcpTable();
     void GetUdpTable();
     void GetNetworkStatistics();
+    void ReadSocketTable(int table);
     
     // Threat analysis
-    void AnalyzeConnectionPattern(const NetworkConnection& conn);
-    bool IsPortScanDetected(const std::string& ip) const;
-    bool IsDDoSDetected(const std::string& ip) const;
+    void AnalyzeNewConnections();
+    void AnalyzeConnectionPattern(const NetworkConnection& conn, bool inbound,
+                                  RateSketch::Clock::time_point now);
+    bool IsPortScanDetected(const IPAddress& ip) const;
+    bool IsDDoSDetected(const IPAddress& ip, RateSketch::Clock::time_point now) const;
+    void RecordPacketSecond();
+    void ScanPacketHalfOpen(std::chrono::system_clock::time_point now);
+    void ReportSynFloods();
+    void ReportSignatureHits(const PacketDecoder::Packet& packet, const SignatureEngine& signatures,
+                             const std::vector<uint32_t>& hits);
     
     // Logging
-    void AddNetworkLog(const std::string& sourceIp, const std::string& destIp,
+    void AddNetworkLog(const IPAddress& sourceIp, const IPAddress& destIp,
                       const std::string& protocol, const std::string& threat,
-                      const std::string& status);
+                      const std::string& status, int severity = 3);
 };
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "IPAddress.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Zero-copy link/network/transport header decoder
+ * Walks Ethernet (with VLAN tags), Linux cooked, BSD loopback and raw IP
+ * framings down to the TCP/UDP header. Nothing is copied except the
+ * addresses; `payload` points back into the caller's buffer.
+ */
+class PacketDecoder {
+public:
+    // pcap LINKTYPE_* values understood by Decode
+    enum LinkType : uint32_t {
+        LinkNull = 0,
+        LinkEthernet = 1,
+        LinkRaw = 101,
+        LinkLinuxSll = 113,
+        LinkIPv4 = 228,
+        LinkIPv6 = 229,
+        LinkLinuxSll2 = 276
+    };
+
+    enum TcpFlags : uint8_t {
+        TcpFin = 0x01,
+        TcpSyn = 0x02,
+        TcpRst = 0x04,
+        TcpPsh = 0x08,
+        TcpAck = 0x10
+    };
+
+    struct Packet {
+        IPAddress sourceIp;
+        IPAddress destinationIp;
+        uint16_t sourcePort;
+        uint16_t destinationPort;
+        uint8_t ipProtocol;     // IPPROTO_* (6 = TCP, 17 = UDP)
+        uint8_t tcpFlags;
+        bool hasTransport;      // false for non-first fragments and unknown protocols
+        const uint8_t* payload;
+        uint32_t payloadLength;
+    };
+
+    static constexpr uint8_t kProtocolTcp = 6;
+    static constexpr uint8_t kProtocolUdp = 17;
+
+    // Returns false when the frame is not IP or is truncated before the IP header
+    static bool Decode(uint32_t linkType, const uint8_t* data, size_t length, Packet& out);
+
+private:
+    static bool DecodeIPv4(const uint8_t* data, size_t length, Packet& out);
+    static bool DecodeIPv6(const uint8_t* data, size_t length, Packet& out);
+    static void DecodeTransport(uint8_t protocol, const uint8_t* data, size_t length, Packet& out);
+};
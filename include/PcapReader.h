@@ -0,0 +1,63 @@
+#pragma once
+
+#include "MappedFile.h"
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Sequential reader for pcap and pcapng capture files
+ * The file is memory-mapped and packets are handed out as pointers into the
+ * mapping, so multi-GB captures are read at disk speed without copies.
+ * Both byte orders, microsecond and nanosecond pcap, and pcapng with
+ * multiple sections and interfaces (per-interface link type and
+ * timestamp resolution) are supported.
+ */
+class PcapReader {
+public:
+    struct Packet {
+        uint64_t timestampNs;     // capture time, nanoseconds since the Unix epoch
+        uint32_t linkType;        // pcap LINKTYPE_* of the capturing interface
+        uint32_t capturedLength;  // bytes available at `data`
+        uint32_t originalLength;  // length on the wire
+        const uint8_t* data;
+    };
+
+    PcapReader();
+
+    bool Open(const std::string& path);
+    void Close();
+
+    // Returns false at end of file or on a malformed record (see GetError)
+    bool Next(Packet& packet);
+
+    bool IsPcapNg() const { return pcapng_; }
+    size_t GetFileSize() const { return file_.Size(); }
+    size_t GetOffset() const { return offset_; }
+    const std::string& GetError() const { return error_; }
+
+private:
+    struct Interface {
+        uint32_t linkType;
+        uint64_t ticksPerSecond;
+        uint64_t offsetSeconds;
+    };
+
+    MappedFile file_;
+    size_t offset_;
+    bool pcapng_;
+    bool swapped_;          // file byte order differs from little-endian host parsing
+    bool nanosecond_;       // classic pcap only
+    uint32_t linkType_;     // classic pcap only
+    std::vector<Interface> interfaces_;  // pcapng only, per section
+    std::string error_;
+
+    uint16_t Read16(const uint8_t* p) const;
+    uint32_t Read32(const uint8_t* p) const;
+
+    bool NextPcap(Packet& packet);
+    bool NextPcapNg(Packet& packet);
+    bool ParseSectionHeader(const uint8_t* block, size_t length);
+    void ParseInterface(const uint8_t* block, size_t length);
+};
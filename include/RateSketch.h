@@ -0,0 +1,41 @@
+#pragma once
+
+#include "IPAddress.h"
+#include <vector>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Fixed-memory per-source event rate estimator
+ * Count-min sketch with conservative update and exponential time decay.
+ * At a steady rate r the estimate converges to r * window, so thresholds
+ * read as "events per window". Memory never grows with the number of
+ * distinct sources; collisions can only over-estimate.
+ */
+class RateSketch {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit RateSketch(std::chrono::seconds window = std::chrono::seconds(60),
+                        size_t width = 16384, size_t depth = 4);
+
+    void Add(const IPAddress& source, double count = 1.0, Clock::time_point now = Clock::now());
+    double Estimate(const IPAddress& source, Clock::time_point now = Clock::now()) const;
+    void Clear();
+
+    std::chrono::seconds GetWindow() const { return window_; }
+    size_t GetMemoryUsage() const { return counters_.size() * sizeof(float); }
+
+private:
+    std::chrono::seconds window_;
+    double inverseWindow_;  // decay rate in 1/seconds
+    size_t width_;          // power of two
+    size_t depth_;
+    std::vector<float> counters_;
+    Clock::time_point landmark_;  // counters are scaled relative to this instant
+
+    double Age(Clock::time_point now) const;
+    void Rescale(Clock::time_point now);
+    size_t Cell(uint64_t hash, size_t row) const;
+};
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+/**
+ * Fixed-capacity multi-producer ring buffer that overwrites its oldest entries
+ * Producers claim a ticket with a single fetch_add and then own one slot; there
+ * is no shared lock, so writers only contend when they land on the same slot
+ * (i.e. when the ring has wrapped under them). Readers copy a consistent tail
+ * by briefly taking each slot's busy bit, which never stalls other slots.
+ *
+ * Each slot's state word is (ticket + 1) << 1 | busy, where ticket + 1 == 0
+ * means the slot has never been written.
+ */
+template <typename T>
+class RingBuffer {
+public:
+    explicit RingBuffer(size_t capacity = 1024)
+        : capacity_(RoundUpPowerOfTwo(capacity)), mask_(capacity_ - 1),
+          slots_(new Slot[capacity_]), head_(0), floor_(0) {
+    }
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    // Returns the ticket assigned to the entry (monotonic across the buffer's lifetime)
+    uint64_t Push(T value) {
+        const uint64_t ticket = head_.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = slots_[ticket & mask_];
+        const uint64_t published = (ticket + 1) << 1;
+
+        uint64_t state = slot.state.load(std::memory_order_relaxed);
+        for (;;) {
+            if (state & kBusy) {
+                std::this_thread::yield();
+                state = slot.state.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (state > published) {
+                return ticket; // a newer lap already overwrote this slot; ours is stale
+            }
+            if (slot.state.compare_exchange_weak(state, published | kBusy,
+                                                 std::memory_order_acquire,
+                                                 std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        slot.value = std::move(value);
+        slot.state.store(published, std::memory_order_release);
+        return ticket;
+    }
+
+    // Visits up to `limit` of the most recent entries, oldest first, as f(entry, ticket).
+    // Entries still being written when the tail is read are skipped.
+    template <typename F>
+    void VisitRecent(size_t limit, F&& f) const {
+        const uint64_t head = head_.load(std::memory_order_acquire);
+        uint64_t first = floor_.load(std::memory_order_acquire);
+        if (head - first > capacity_) first = head - capacity_;
+        if (head - first > limit) first = head - limit;
+
+        for (uint64_t ticket = first; ticket < head; ++ticket) {
+            Slot& slot = slots_[ticket & mask_];
+            uint64_t expected = (ticket + 1) << 1;
+            // Only the exact published ticket is copied; anything else is in flight or overwritten
+            if (!slot.state.compare_exchange_strong(expected, expected | kBusy,
+                                                    std::memory_order_acquire,
+                                                    std::memory_order_relaxed)) {
+                continue;
+            }
+            f(static_cast<const T&>(slot.value), ticket);
+            slot.state.store((ticket + 1) << 1, std::memory_order_release);
+        }
+    }
+
+    std::vector<T> Snapshot(size_t limit) const {
+        std::vector<T> result;
+        result.reserve(limit < capacity_ ? limit : capacity_);
+        VisitRecent(limit, [&result](const T& value, uint64_t) { result.push_back(value); });
+        return result;
+    }
+
+    // Hides all current entries from readers; slots are reclaimed as they are overwritten
+    void Clear() { floor_.store(head_.load(std::memory_order_acquire), std::memory_order_release); }
+
+    size_t Size() const {
+        const uint64_t head = head_.load(std::memory_order_acquire);
+        const uint64_t count = head - floor_.load(std::memory_order_acquire);
+        return static_cast<size_t>(count < capacity_ ? count : capacity_);
+    }
+
+    size_t Capacity() const { return capacity_; }
+    uint64_t GetTotalPushed() const { return head_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint64_t kBusy = 1;
+
+    // One cache line per slot header so neighbouring producers do not false-share
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> state{0};
+        T value{};
+    };
+
+    static size_t RoundUpPowerOfTwo(size_t value) {
+        size_t result = 2;
+        while (result < value) result <<= 1;
+        return result;
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    alignas(64) std::atomic<uint64_t> head_;
+    alignas(64) std::atomic<uint64_t> floor_;
+};
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <random>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Periodic job scheduler driven by a hierarchical timer wheel
+ * Each job has its own interval and jitter. A single timer thread keeps the
+ * next run of every job in a four-level wheel (64 slots per level, one tick
+ * per slot on the first level), sleeps until the earliest deadline and hands
+ * due jobs to a small worker pool, so a slow job only holds up its own
+ * worker. Runs keep a fixed rate: the next deadline follows from the previous
+ * one, not from when the run finished.
+ *
+ * A job never overlaps itself. A deadline that passes while the job is still
+ * queued or running is skipped and counted as missed. Stop() wakes the timer
+ * thread at once, drops runs that have not started and waits only for the
+ * ones already running; long jobs can poll IsStopping() to bail out early.
+ */
+class Scheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Task = std::function<void()>;
+    using JobId = uint32_t;
+
+    static constexpr JobId kInvalidJob = 0;
+
+    struct Config {
+        size_t workers = 2;
+        std::chrono::milliseconds tick{10};   // wheel resolution
+    };
+
+    struct JobStats {
+        std::string name;
+        std::chrono::milliseconds interval;
+        std::chrono::milliseconds jitter;
+        uint64_t runs;
+        uint64_t missedDeadlines;   // deadlines skipped while the job was still queued or running
+        uint64_t failures;          // runs that threw
+        std::chrono::microseconds lastDuration;
+        std::chrono::microseconds maxDuration;
+        bool running;
+    };
+
+    Scheduler();
+    explicit Scheduler(const Config& config);
+    ~Scheduler();
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    // Jobs may be added before or after Start(); the first run is one
+    // interval (plus jitter) after the job is added or the scheduler starts
+    JobId AddJob(const std::string& name, std::chrono::milliseconds interval,
+                 std::chrono::milliseconds jitter, Task task);
+    // A run already in progress finishes; no further runs start
+    bool RemoveJob(JobId id);
+    bool SetInterval(JobId id, std::chrono::milliseconds interval, std::chrono::milliseconds jitter);
+
+    bool Start();
+    void Stop();
+    bool IsRunning() const;
+    bool IsStopping() const;
+
+    std::vector<JobStats> GetStats() const;
+
+private:
+    static constexpr size_t kLevels = 4;
+    static constexpr size_t kSlotBits = 6;
+    static constexpr size_t kSlots = size_t(1) << kSlotBits;
+
+    struct Job {
+        JobId id;                   // kInvalidJob once removed
+        std::string name;
+        Task task;
+        std::chrono::milliseconds interval;
+        std::chrono::milliseconds jitter;
+        uint64_t base;              // deadline before jitter, in ticks
+        uint64_t expiry;            // tick the job fires at
+        uint32_t generation;        // bumped on every re-arm; older wheel entries are stale
+        bool queued;
+        bool running;
+        uint64_t runs;
+        uint64_t missedDeadlines;
+        uint64_t failures;
+        std::chrono::microseconds lastDuration;
+        std::chrono::microseconds maxDuration;
+    };
+
+    // An entry whose generation no longer matches its job's is stale (the job
+    // was removed or re-armed) and is dropped when its slot comes up
+    struct Timer {
+        uint32_t job;
+        uint32_t generation;
+        uint64_t expiry;
+    };
+
+    Config config_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable timerWake_;
+    std::condition_variable workReady_;
+
+    std::vector<Job> jobs_;         // indexed by id - 1; removed jobs keep their slot
+    std::vector<Timer> wheel_[kLevels][kSlots];
+    std::deque<size_t> ready_;
+    Clock::time_point epoch_;       // time of tick 0
+    uint64_t currentTick_;
+    bool started_;
+    bool stopping_;
+    std::mt19937 random_;
+
+    std::thread timerThread_;
+    std::vector<std::thread> workers_;
+
+    uint64_t TickAt(Clock::time_point time) const;
+    uint64_t TicksFor(std::chrono::milliseconds duration) const;
+    void Arm(size_t index, uint64_t base);
+    void Place(const Timer& timer);
+    void Advance(uint64_t tick);
+    void Fire(size_t index);
+    uint64_t NextExpiry() const;
+    void TimerLoop();
+    void WorkerLoop();
+};
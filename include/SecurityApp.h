@@ -10,6 +10,7 @@
 class ViewManager;
 class GeminiClient;
 class SecurityMonitor;
+class NetworkMonitor;
 
 /**
  * Main application class for Windows 11 Security Sentinel
@@ -33,6 +34,15 @@ public:
     GeminiClient* GetGeminiClient() const { return geminiClient_.get(); }
     SecurityMonitor* GetSecurityMonitor() const { return securityMonitor_.get(); }
 
+    // Applies the [threat_intel] settings of the loaded configuration
+    static void ConfigureThreatIntel(NetworkMonitor& monitor);
+    // Compiles the [signatures] file, if present, into the payload scanner
+    static void ConfigureSignatures(NetworkMonitor& monitor);
+    // Installs the process-wide reverse-DNS resolver from [dns]
+    static void ConfigureDns();
+    // Applies the [monitoring] check intervals
+    static void ConfigureChecks(SecurityMonitor& monitor);
+
 private:
     std::unique_ptr<ViewManager> viewManager_;
     std::unique_ptr<GeminiClient> geminiClient_;
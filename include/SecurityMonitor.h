@@ -8,6 +8,12 @@
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include "RingBuffer.h"
+#include "TimeSeries.h"
+#include "Scheduler.h"
+#include "LinuxProcessTable.h"
+
+class NetworkMonitor;
 
 /**
  * Core security monitoring system
@@ -31,9 +37,19 @@ public:
         std::chrono::system_clock::time_point lastUpdate;
     };
 
+    // Field order of MetricsSeries points
+    enum MetricsField : size_t {
+        FieldCpuUsage,
+        FieldMemoryUsage,
+        FieldActiveConnections,
+        FieldSuspiciousActivity,
+        MetricsFieldCount
+    };
+    using MetricsSeries = TimeSeries<MetricsFieldCount>;
+
     using EventCallback = std::function<void(const SecurityEvent&)>;
 
-    SecurityMonitor();
+    explicit SecurityMonitor(size_t eventCapacity = 1024);
     ~SecurityMonitor();
 
     // Monitoring control
@@ -48,25 +64,53 @@ public:
 
     // System metrics
     SystemMetrics GetCurrentMetrics() const;
-    std::vector<SystemMetrics> GetMetricsHistory(int minutes = 60) const;
+    std::vector<SystemMetrics> GetMetricsHistory(int minutes = 60) const;  // bucket means
+    std::vector<MetricsSeries::Point> GetMetricsSeries(int minutes = 60) const;  // min/max/sum per bucket
 
     // Threat analysis
     int GetThreatLevel() const; // 1-5 scale
     std::string GetThreatSummary() const;
 
+    // Connection scanning and packet detectors; their detections become events
+    NetworkMonitor& GetNetworkMonitor() { return *networkMonitor_; }
+
+    // Periodic checks. Each runs on its own interval with up to `jitter` of
+    // random delay; the built-in ones are "processes", "network", "resources"
+    // and "filesystem". A check that throws raises an ERROR event.
+    bool AddCheck(const std::string& name, std::chrono::milliseconds interval,
+                  std::chrono::milliseconds jitter, std::function<void()> check);
+    bool SetCheckInterval(const std::string& name, std::chrono::milliseconds interval,
+                          std::chrono::milliseconds jitter);
+    std::vector<Scheduler::JobStats> GetCheckStats() const { return scheduler_->GetStats(); }
+
+    // Processes seen by the last process check (Linux), ordered by pid
+    std::vector<LinuxProcessTable::Process> GetProcesses() const;
+
 private:
     std::atomic<bool> isMonitoring_;
-    std::thread monitoringThread_;
     EventCallback eventCallback_;
+
+    std::unique_ptr<Scheduler> scheduler_;
+    mutable std::mutex checksMutex_;
+    std::vector<std::pair<std::string, Scheduler::JobId>> checks_;
     
-    mutable std::mutex eventsMutex_;
-    std::vector<SecurityEvent> events_;
+    RingBuffer<SecurityEvent> events_;
     
     mutable std::mutex metricsMutex_;
-    std::vector<SystemMetrics> metricsHistory_;
+    MetricsSeries metricsHistory_;
+
+    std::unique_ptr<NetworkMonitor> networkMonitor_;
+
+    // Touched by the process check, which never overlaps itself, and by
+    // GetProcesses under processMutex_
+    mutable std::mutex processMutex_;
+    LinuxProcessTable processTable_;
+    std::vector<LinuxProcessTable::Change> processChanges_;
+    size_t processScans_;
+    size_t processesSpawned_;
+    size_t processesExited_;
 
     // Monitoring methods
-    void MonitoringLoop();
     void CheckProcesses();
     void CheckNetworkActivity();
     void CheckSystemResources();
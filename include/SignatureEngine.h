@@ -0,0 +1,118 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Multi-pattern byte-signature matcher for payloads and file contents
+ * Signatures compile into an Aho-Corasick automaton numbered breadth-first,
+ * so every state's children are consecutive states and a sparse state needs
+ * only its children's label bytes; the root and other high-fanout states get
+ * a full 256-entry transition row instead.
+ *
+ * Most input never reaches the automaton. A Bloom filter holds the 4-byte
+ * grams at the first `stride` offsets of every signature, and is probed once
+ * every `stride` input bytes (eight probes per step with AVX2, selected at
+ * run time; scalar otherwise). The automaton only walks from positions where
+ * a signature could start and drops back to the root as soon as no such
+ * position lies inside its current partial match.
+ *
+ * Scanning streams: a Stream carries the automaton state from one buffer to
+ * the next, so a signature split across packets or file chunks is still
+ * found. A compiled engine is immutable and can be shared between threads,
+ * each scanning with its own Stream.
+ */
+class SignatureEngine {
+public:
+    static constexpr size_t kMinSignatureLength = 4;
+    static constexpr size_t kMaxSignatureLength = 65535;
+
+    struct Match {
+        uint32_t signature;  // id returned by AddSignature
+        uint64_t end;        // stream offset one past the last matched byte
+    };
+
+    using MatchCallback = std::function<void(const Match&)>;
+
+    struct Stream {
+        uint32_t state = 0;   // automaton state after the bytes scanned so far
+        uint64_t offset = 0;  // bytes scanned so far
+    };
+
+    enum class Prefilter {
+        Auto,    // AVX2 when the CPU has it
+        Scalar,
+        Avx2
+    };
+
+    SignatureEngine();
+
+    // Returns the signature id, or -1 (see GetError) when the signature is
+    // too short or long or the engine is already compiled
+    int AddSignature(const std::string& name, std::string_view bytes);
+    int AddHexSignature(const std::string& name, std::string_view hex);
+    // Loads "name:hexbytes" lines; blank lines and '#' comments are skipped,
+    // malformed lines are skipped and counted in `rejected`
+    bool LoadFile(const std::string& path, size_t* rejected = nullptr);
+    bool Compile();
+
+    bool IsCompiled() const { return compiled_; }
+    const std::string& GetError() const { return error_; }
+
+    void Scan(Stream& stream, const uint8_t* data, size_t length, const MatchCallback& onMatch) const;
+
+    // Kernel choice; Avx2 falls back to Scalar on CPUs without it
+    void SetPrefilter(Prefilter prefilter);
+    Prefilter GetPrefilter() const { return prefilter_; }  // resolved, never Auto
+    static bool HasAvx2();
+
+    size_t GetSignatureCount() const { return names_.size(); }
+    const std::string& GetSignatureName(uint32_t id) const { return names_[id]; }
+    size_t GetSignatureLength(uint32_t id) const { return lengths_[id]; }
+    size_t GetStateCount() const { return states_.size(); }
+    size_t GetStride() const { return stride_; }
+    size_t GetMemoryUsage() const;
+
+private:
+    struct State {
+        uint32_t children;    // first child state, or row index when childCount == kDenseRow
+        uint32_t fail;
+        uint32_t output;      // head of the output chain in outputs_, 0 = none
+        uint16_t childCount;
+        uint16_t depth;       // length of the path from the root
+    };
+
+    static constexpr uint16_t kDenseRow = 0xFFFF;
+
+    std::vector<std::string> names_;
+    std::vector<uint32_t> lengths_;
+    std::string patterns_;                // signature bytes back to back, dropped by Compile
+    std::vector<uint64_t> patternOffsets_;
+
+    std::vector<State> states_;
+    std::vector<uint8_t> labels_;         // byte on the edge into each state
+    std::vector<uint32_t> rows_;          // 256 complete transitions per dense state
+    std::vector<uint32_t> outputs_;       // chain records: next, count, signature ids
+
+    std::vector<uint64_t> filter_;        // gram Bloom filter, two bits per gram
+    uint32_t filterShift_;
+    uint32_t filterMask_;
+    size_t stride_;
+    std::vector<uint64_t> prefixFilter_;  // confirms candidate starts
+    uint32_t prefixShift_;
+    size_t prefixLength_;
+    uint64_t prefixMask_;
+
+    Prefilter prefilter_;
+    bool compiled_;
+    std::string error_;
+
+    uint32_t Step(uint32_t state, uint8_t byte) const;
+    void Report(uint32_t state, uint64_t end, const MatchCallback& onMatch) const;
+    void BuildFilter();
+    void MarkCandidates(const uint8_t* data, size_t length, size_t begin, size_t end, uint64_t* bits) const;
+};
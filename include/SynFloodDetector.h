@@ -0,0 +1,99 @@
+#pragma once
+
+#include "IPAddress.h"
+#include "IPPrefixSet.h"
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Per-listener SYN-flood detection from half-open (SYN_RECV) sockets
+ * Fed one scan at a time: BeginScan, AddHalfOpen for every half-open socket
+ * or flow, then EndScan. Listener and source-prefix maps persist between
+ * scans and are tagged with the scan generation, so a counter is reset on
+ * its first touch in a new scan instead of rebuilding the maps each cycle;
+ * EndScan only visits listeners that were touched. A listener alerts when
+ * its half-open count is both large and well above its own moving baseline.
+ */
+class SynFloodDetector {
+public:
+    struct Config {
+        uint32_t minHalfOpen = 128;      // absolute floor before anything alerts
+        double baselineFactor = 4.0;     // count must exceed baseline * factor
+        double baselineWeight = 0.2;     // EWMA weight of each quiet scan
+        int ipv4PrefixLength = 24;       // sources are aggregated to these prefixes
+        int ipv6PrefixLength = 64;
+        size_t topSources = 5;
+        uint32_t cooldownScans = 12;     // re-alert sooner only if the count doubles
+        uint32_t staleScans = 120;       // forget listeners idle this long
+    };
+
+    struct SourceCount {
+        IPPrefixSet::Prefix prefix;
+        uint32_t halfOpen;
+    };
+
+    struct Alert {
+        IPAddress listenerAddress;
+        uint16_t listenerPort;
+        uint32_t halfOpen;
+        double baseline;
+        uint32_t distinctSources;
+        std::vector<SourceCount> topSources;  // largest first
+    };
+
+    SynFloodDetector();
+    explicit SynFloodDetector(const Config& config);
+
+    void BeginScan();
+    void AddHalfOpen(const IPAddress& listenerAddress, uint16_t listenerPort, const IPAddress& source);
+    // Evaluates the scan; alerts are appended to `alerts`
+    void EndScan(std::vector<Alert>& alerts);
+
+    uint32_t GetHalfOpen(const IPAddress& listenerAddress, uint16_t listenerPort) const;
+    size_t GetListenerCount() const { return listeners_.size(); }
+    void Clear();
+
+private:
+    struct ListenerKey {
+        IPAddress address;
+        uint16_t port;
+
+        bool operator==(const ListenerKey& other) const {
+            return port == other.port && address == other.address;
+        }
+    };
+
+    struct ListenerKeyHash {
+        size_t operator()(const ListenerKey& key) const noexcept {
+            return static_cast<size_t>(key.address.Hash() ^ (static_cast<uint64_t>(key.port) * 0x9E3779B97F4A7C15ull));
+        }
+    };
+
+    struct SourceEntry {
+        uint32_t generation = 0;
+        uint32_t count = 0;
+    };
+
+    struct Listener {
+        uint32_t generation = 0;   // last scan that touched this listener
+        uint32_t count = 0;        // half-open sockets in that scan
+        uint32_t liveSources = 0;  // source prefixes touched in that scan
+        double baseline = 0.0;
+        uint32_t lastAlertScan = 0;
+        uint32_t lastAlertCount = 0;
+        std::unordered_map<IPAddress, SourceEntry> sources;  // keyed by prefix network address
+    };
+
+    using ListenerMap = std::unordered_map<ListenerKey, Listener, ListenerKeyHash>;
+
+    Config config_;
+    ListenerMap listeners_;
+    std::vector<ListenerMap::value_type*> touched_;
+    uint32_t generation_;
+
+    IPAddress SourcePrefix(const IPAddress& source) const;
+    void Evaluate(const ListenerKey& key, Listener& listener, std::vector<Alert>& alerts);
+    void Sweep();
+};
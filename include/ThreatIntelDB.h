@@ -0,0 +1,102 @@
+#pragma once
+
+#include "IPAddress.h"
+#include "MappedFile.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Compiled, memory-mapped threat-intelligence database
+ * Plain-text IOC feeds (one indicator per line: IP, CIDR, domain or
+ * MD5/SHA-1/SHA-256 hex digest; hosts-file and "||domain^" lines are
+ * accepted) are compiled into one binary file of sorted, fixed-size
+ * records. Opening it is an mmap plus header checks, so a restart does not
+ * reparse the feeds; lookups binary-search the mapped tables in place.
+ *
+ * A split-block Bloom filter (one 32-byte block, eight bits per key) sits
+ * in front of every table and answers most "not listed" queries with a
+ * single cache-line read. Shorter CIDR ranges go into a second, small
+ * filter at a few fixed prefix granularities; an address probes only the
+ * granularities the feeds actually use, and that filter normally stays in
+ * cache. Domains match themselves and their subdomains.
+ *
+ * An opened database is immutable and safe to read from any thread.
+ */
+class ThreatIntelDB {
+public:
+    enum class IndicatorType : uint8_t {
+        Address,   // IPv4/IPv6 address or CIDR range
+        Domain,
+        FileHash   // MD5, SHA-1 or SHA-256
+    };
+
+    struct Match {
+        IndicatorType type;
+        std::string_view feed;  // feed file name; valid while the database is open
+    };
+
+    struct CompileStats {
+        uint64_t lines;
+        uint64_t addressRanges;  // after merging overlapping ranges
+        uint64_t domains;
+        uint64_t fileHashes;
+        uint64_t rejected;       // lines that held no recognisable indicator
+        uint64_t fileSize;
+        std::chrono::milliseconds elapsed;
+    };
+
+    ThreatIntelDB();
+
+    ThreatIntelDB(const ThreatIntelDB&) = delete;
+    ThreatIntelDB& operator=(const ThreatIntelDB&) = delete;
+
+    // Compiles the feeds (files, or directories of feed files) into
+    // `outputPath`. The file is written aside and renamed into place, so
+    // processes that already mapped the old file keep reading it unharmed.
+    static bool Compile(const std::vector<std::string>& feedPaths, const std::string& outputPath,
+                        CompileStats* stats, std::string& error);
+    // Identifies the feed set by path, size and modification time
+    static uint64_t FeedFingerprint(const std::vector<std::string>& feedPaths);
+
+    bool Open(const std::string& path);
+    bool IsOpen() const { return header_ != nullptr; }
+    const std::string& GetError() const { return error_; }
+    uint64_t GetFeedFingerprint() const;  // as recorded by Compile
+
+    bool LookupIP(const IPAddress& ip, Match* match = nullptr) const;
+    bool LookupDomain(std::string_view domain, Match* match = nullptr) const;
+    bool LookupHash(std::string_view hexDigest, Match* match = nullptr) const;
+
+    size_t GetIndicatorCount() const;
+    size_t GetFeedCount() const;
+    size_t GetFileSize() const { return file_.Size(); }
+
+private:
+    struct Header;
+    struct V4Range;
+    struct V6Range;
+    struct DomainRecord;
+
+    MappedFile file_;
+    const Header* header_;
+    std::string error_;
+
+    const uint32_t* bloom_;       // exact keys: host addresses, domains, digests
+    uint64_t bloomBlocks_;
+    const uint32_t* rangeBloom_;  // CIDR ranges shorter than a host address
+    uint64_t rangeBloomBlocks_;
+    const V4Range* v4_;
+    const V6Range* v6_;
+    const DomainRecord* domains_;
+    const char* domainText_;
+    const uint8_t* digests_[3];  // MD5, SHA-1, SHA-256 record tables
+    const uint32_t* feedOffsets_;
+    const char* feedNames_;
+
+    bool FindDigest(int kind, const uint8_t* digest, Match* match) const;
+    void SetMatch(Match* match, IndicatorType type, uint32_t feed) const;
+};
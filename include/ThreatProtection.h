@@ -4,7 +4,9 @@
 #include <vector>
 #include <memory>
 #include <chrono>
-#include <set>
+#include "IPAddress.h"
+#include "IPPrefixSet.h"
+#include "DomainTrie.h"
 
 class SecurityApp;
 
@@ -50,9 +52,20 @@ public:
     ProtectionLevel GetProtectionLevel() const;
     
     // Blocking and filtering
-    void BlockIP(const std::string& ip);
+    void BlockIP(const IPAddress& ip, int prefixLength = -1);  // -1 = single address
+    void BlockIP(const std::string& ip);                       // address or CIDR range
+    void UnblockIP(const IPAddress& ip, int prefixLength = -1);
     void UnblockIP(const std::string& ip);
+    bool IsIPBlocked(const IPAddress& ip) const;
+    bool IsIPBlocked(const std::string& ip) const;
     std::vector<std::string> GetBlockedIPs() const;
+
+    // "example.com" blocks the domain and its subdomains, "*.example.com"
+    // only the subdomains
+    void BlockDomain(const std::string& domain);
+    void UnblockDomain(const std::string& domain);
+    bool IsDomainBlocked(const std::string& hostname) const;
+    std::vector<std::string> GetBlockedDomains() const;
     
     // Status
     bool IsProtectionActive() const;
@@ -63,7 +76,8 @@ private:
     ProtectionLevel protectionLevel_;
     std::vector<ThreatInfo> activeThreats_;
     std::vector<ThreatInfo> threatHistory_;
-    std::set<std::string> blockedIPs_;
+    IPPrefixSet blockedIPs_;
+    DomainTrie blockedDomains_;
     
     void ScanForThreats();
     void ProcessThreat(const ThreatInfo& threat);
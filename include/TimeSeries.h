@@ -0,0 +1,181 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Fixed-memory, multi-resolution history of N numeric fields
+ * Every sample is folded into one bucket per tier (by default 1s for an hour,
+ * 1m for a week and 1h for a year). Each bucket keeps a running min/max/sum,
+ * so rollups cost O(tiers * N) on insert and nothing on read. A query uses
+ * the finest tier that still covers the requested start time and touches
+ * only the buckets inside the range. Not thread-safe; callers hold their own lock.
+ */
+template <size_t N>
+class TimeSeries {
+public:
+    using Clock = std::chrono::system_clock;
+
+    struct Tier {
+        std::chrono::seconds resolution;
+        size_t buckets;
+    };
+
+    struct Rollup {
+        double min;
+        double max;
+        double sum;
+    };
+
+    struct Point {
+        Clock::time_point start;          // beginning of the bucket
+        std::chrono::seconds resolution;  // width of the bucket
+        uint32_t count;                   // samples folded into it
+        std::array<Rollup, N> fields;
+
+        double Mean(size_t field) const { return count ? fields[field].sum / count : 0.0; }
+    };
+
+    static std::vector<Tier> DefaultTiers() {
+        return {
+            {std::chrono::seconds(1), 3600},      // 1 hour
+            {std::chrono::seconds(60), 10080},    // 7 days
+            {std::chrono::seconds(3600), 8760},   // 1 year
+        };
+    }
+
+    explicit TimeSeries(std::vector<Tier> tiers = DefaultTiers()) {
+        for (const Tier& tier : tiers) {
+            if (tier.resolution.count() > 0 && tier.buckets > 0) {
+                tiers_.push_back(Ring{tier, std::vector<Bucket>(tier.buckets), kNoBucket});
+            }
+        }
+        std::sort(tiers_.begin(), tiers_.end(), [](const Ring& a, const Ring& b) {
+            return a.tier.resolution < b.tier.resolution;
+        });
+    }
+
+    void Record(Clock::time_point time, const std::array<double, N>& values) {
+        const int64_t seconds = ToSeconds(time);
+        for (Ring& ring : tiers_) {
+            const int64_t index = FloorDiv(seconds, ring.tier.resolution.count());
+            Bucket& bucket = ring.buckets[Slot(ring, index)];
+            if (bucket.index != index) {
+                if (bucket.index > index) {
+                    continue; // older than this tier's retention
+                }
+                bucket.index = index;
+                bucket.count = 0;
+            }
+            for (size_t i = 0; i < N; ++i) {
+                Rollup& rollup = bucket.fields[i];
+                if (bucket.count == 0) {
+                    rollup = Rollup{values[i], values[i], values[i]};
+                } else {
+                    rollup.min = std::min(rollup.min, values[i]);
+                    rollup.max = std::max(rollup.max, values[i]);
+                    rollup.sum += values[i];
+                }
+            }
+            bucket.count++;
+            ring.latest = std::max(ring.latest, index);
+        }
+    }
+
+    // Buckets overlapping [from, to], oldest first, from the finest tier covering `from`
+    std::vector<Point> Query(Clock::time_point from, Clock::time_point to) const {
+        std::vector<Point> result;
+        const Ring* ring = SelectTier(from);
+        if (!ring || ring->latest == kNoBucket || to < from) {
+            return result;
+        }
+
+        const int64_t resolution = ring->tier.resolution.count();
+        const int64_t oldest = ring->latest - static_cast<int64_t>(ring->buckets.size()) + 1;
+        const int64_t first = std::max(FloorDiv(ToSeconds(from), resolution), oldest);
+        const int64_t last = std::min(FloorDiv(ToSeconds(to), resolution), ring->latest);
+        if (first > last) {
+            return result;
+        }
+
+        result.reserve(static_cast<size_t>(last - first + 1));
+        for (int64_t index = first; index <= last; ++index) {
+            const Bucket& bucket = ring->buckets[Slot(*ring, index)];
+            if (bucket.index != index || bucket.count == 0) {
+                continue;
+            }
+            result.push_back(Point{Clock::time_point(std::chrono::seconds(index * resolution)),
+                                   ring->tier.resolution, bucket.count, bucket.fields});
+        }
+        return result;
+    }
+
+    void Clear() {
+        for (Ring& ring : tiers_) {
+            std::fill(ring.buckets.begin(), ring.buckets.end(), Bucket());
+            ring.latest = kNoBucket;
+        }
+    }
+
+    size_t GetMemoryUsage() const {
+        size_t total = 0;
+        for (const Ring& ring : tiers_) {
+            total += ring.buckets.capacity() * sizeof(Bucket);
+        }
+        return total;
+    }
+
+private:
+    static constexpr int64_t kNoBucket = std::numeric_limits<int64_t>::min();
+
+    struct Bucket {
+        int64_t index = kNoBucket;  // bucket number since the epoch at this tier's resolution
+        uint32_t count = 0;
+        std::array<Rollup, N> fields{};
+    };
+
+    struct Ring {
+        Tier tier;
+        std::vector<Bucket> buckets;
+        int64_t latest;
+    };
+
+    std::vector<Ring> tiers_;
+
+    const Ring* SelectTier(Clock::time_point from) const {
+        const Ring* coarsest = nullptr;
+        for (const Ring& ring : tiers_) {
+            coarsest = &ring;
+            if (ring.latest == kNoBucket) {
+                continue;
+            }
+            const int64_t resolution = ring.tier.resolution.count();
+            const int64_t oldest = ring.latest - static_cast<int64_t>(ring.buckets.size()) + 1;
+            // Allow one bucket of slack so "the last hour" still maps to the hour-long tier
+            if (FloorDiv(ToSeconds(from), resolution) >= oldest - 1) {
+                return &ring;
+            }
+        }
+        return coarsest;
+    }
+
+    static int64_t ToSeconds(Clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+    }
+
+    static int64_t FloorDiv(int64_t value, int64_t divisor) {
+        int64_t quotient = value / divisor;
+        return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+    }
+
+    static size_t Slot(const Ring& ring, int64_t index) {
+        const int64_t size = static_cast<int64_t>(ring.buckets.size());
+        int64_t slot = index % size;
+        return static_cast<size_t>(slot < 0 ? slot + size : slot);
+    }
+};
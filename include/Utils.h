@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <chrono>
 #include <set>
@@ -23,11 +24,12 @@ namespace Utils {
     std::string FormatDuration(const std::chrono::seconds& duration);
     std::chrono::system_clock::time_point ParseTime(const std::string& timeStr);
 
-    // Network utilities
-    bool IsValidIPv4(const std::string& ip);
-    bool IsValidIPv6(const std::string& ip);
-    bool IsPrivateIP(const std::string& ip);
-    bool IsLocalIP(const std::string& ip);
+    // Network utilities (IPAddress::Parse/Classify underneath; no allocation)
+    bool IsValidIPv4(std::string_view ip);
+    bool IsValidIPv6(std::string_view ip);
+    bool IsPrivateIP(std::string_view ip);   // RFC 1918 or IPv6 unique local
+    bool IsLocalIP(std::string_view ip);     // loopback address or "localhost"
+    // Never blocks: returns `ip` itself until a background lookup finds a name
     std::string GetHostname(const std::string& ip);
     std::string GetLocalIP();
 
@@ -54,8 +56,9 @@ namespace Utils {
 
     // System utilities
     std::string GetSystemInfo();
-    double GetCPUUsage();
+    double GetCPUUsage();       // percent busy since the previous call; 0 on the first
     double GetMemoryUsage();
+    bool GetLoadAverage(double& one, double& five, double& fifteen);  // false where unavailable
     std::vector<std::string> GetRunningProcesses();
     bool IsProcessRunning(const std::string& processName);
     bool IsRunningAsAdmin();
@@ -0,0 +1,272 @@
+#include "DnsResolver.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netdb.h>
+#endif
+
+namespace {
+
+std::shared_ptr<DnsResolver>& GlobalResolver() {
+    static std::shared_ptr<DnsResolver> resolver;
+    return resolver;
+}
+
+} // namespace
+
+DnsResolver::DnsResolver()
+    : DnsResolver(Config()) {
+}
+
+DnsResolver::DnsResolver(const Config& config, LookupFunction lookup)
+    : config_(config), lookup_(std::move(lookup)),
+      shardCapacity_(std::max<size_t>(config.cacheCapacity / kShardCount, 1)),
+      running_(0), stopping_(false),
+      hits_(0), misses_(0), coalesced_(0), lookups_(0), dropped_(0) {
+    if (!lookup_) {
+        lookup_ = SystemLookup;
+    }
+}
+
+DnsResolver::~DnsResolver() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        stopping_ = true;
+    }
+    queueReady_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+DnsResolver::Shard& DnsResolver::ShardFor(const IPAddress& address) {
+    // Top bits: the unordered_map inside the shard consumes the low ones
+    return shards_[address.Hash() >> 60];
+}
+
+DnsResolver::Result DnsResolver::Resolve(const IPAddress& address) {
+    Shard& shard = ShardFor(address);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(address);
+        if (it != shard.index.end()) {
+            Entry& entry = *it->second;
+            if (entry.status == Status::Pending) {
+                coalesced_++;
+                return Result{Status::Pending, std::string()};
+            }
+            shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+            if (entry.expires > Clock::now()) {
+                hits_++;
+                return Result{entry.status, entry.hostname};
+            }
+            // Expired: look it up again
+            entry.status = Status::Pending;
+            entry.hostname.clear();
+        } else {
+            shard.entries.push_front(Entry{address, Status::Pending, std::string(), Clock::time_point()});
+            shard.index.emplace(address, shard.entries.begin());
+            Evict(shard);
+        }
+    }
+
+    misses_++;
+    if (!Enqueue(address)) {
+        // Drop the marker so the next request tries again
+        dropped_++;
+        Forget(address);
+    }
+    return Result{Status::Pending, std::string()};
+}
+
+void DnsResolver::Evict(Shard& shard) {
+    // A pending entry may go too; its lookup simply stores the result afresh
+    while (shard.entries.size() > shardCapacity_) {
+        shard.index.erase(shard.entries.back().address);
+        shard.entries.pop_back();
+    }
+}
+
+void DnsResolver::Store(const IPAddress& address, Status status, std::string hostname) {
+    const auto expires = Clock::now() + (status == Status::Resolved ? config_.positiveTtl : config_.negativeTtl);
+    Shard& shard = ShardFor(address);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(address);
+    if (it != shard.index.end()) {
+        shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+        Entry& entry = *it->second;
+        entry.status = status;
+        entry.hostname = std::move(hostname);
+        entry.expires = expires;
+        return;
+    }
+    shard.entries.push_front(Entry{address, status, std::move(hostname), expires});
+    shard.index.emplace(address, shard.entries.begin());
+    Evict(shard);
+}
+
+void DnsResolver::Forget(const IPAddress& address) {
+    Shard& shard = ShardFor(address);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(address);
+    if (it != shard.index.end() && it->second->status == Status::Pending) {
+        shard.entries.erase(it->second);
+        shard.index.erase(it);
+    }
+}
+
+bool DnsResolver::Enqueue(const IPAddress& address) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        if (stopping_ || queue_.size() >= config_.maxQueued) {
+            return false;
+        }
+        queue_.push_back(address);
+        if (workers_.empty()) {
+            const size_t count = std::max<size_t>(config_.workers, 1);
+            for (size_t i = 0; i < count; ++i) {
+                workers_.emplace_back(&DnsResolver::WorkerLoop, this);
+            }
+        }
+    }
+    queueReady_.notify_one();
+    return true;
+}
+
+void DnsResolver::WorkerLoop() {
+    for (;;) {
+        IPAddress address;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            queueReady_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            address = queue_.front();
+            queue_.pop_front();
+            running_++;
+        }
+
+        std::string hostname;
+        const bool found = lookup_(address, hostname);
+        lookups_++;
+        Store(address, found ? Status::Resolved : Status::NotFound, found ? std::move(hostname) : std::string());
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            running_--;
+            if (queue_.empty() && running_ == 0) {
+                queueIdle_.notify_all();
+            }
+        }
+    }
+}
+
+bool DnsResolver::WaitIdle(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(queueMutex_);
+    return queueIdle_.wait_for(lock, timeout, [this] { return queue_.empty() && running_ == 0; });
+}
+
+DnsResolver::Stats DnsResolver::GetStats() const {
+    Stats stats;
+    stats.hits = hits_.load();
+    stats.misses = misses_.load();
+    stats.coalesced = coalesced_.load();
+    stats.lookups = lookups_.load();
+    stats.dropped = dropped_.load();
+    stats.cached = 0;
+    for (const Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.cached += shard.entries.size();
+    }
+    return stats;
+}
+
+bool DnsResolver::SystemLookup(const IPAddress& address, std::string& hostname) {
+#ifdef _WIN32
+    static const bool started = [] {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    if (!started) {
+        return false;
+    }
+#endif
+    sockaddr_storage storage;
+    std::memset(&storage, 0, sizeof(storage));
+    socklen_t length;
+    if (address.IsIPv4()) {
+        auto* in = reinterpret_cast<sockaddr_in*>(&storage);
+        in->sin_family = AF_INET;
+        std::memcpy(&in->sin_addr, address.Bytes() + 12, 4);
+        length = sizeof(sockaddr_in);
+    } else {
+        auto* in6 = reinterpret_cast<sockaddr_in6*>(&storage);
+        in6->sin6_family = AF_INET6;
+        std::memcpy(&in6->sin6_addr, address.Bytes(), 16);
+        length = sizeof(sockaddr_in6);
+    }
+
+    char host[NI_MAXHOST];
+    if (getnameinfo(reinterpret_cast<sockaddr*>(&storage), length, host, sizeof(host), nullptr, 0, NI_NAMEREQD) != 0) {
+        return false;
+    }
+    hostname = host;
+    return true;
+}
+
+DnsResolver::LookupFunction DnsResolver::HostsFileLookup(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return LookupFunction();
+    }
+
+    auto names = std::make_shared<std::unordered_map<IPAddress, std::string>>();
+    std::string line;
+    while (std::getline(file, line)) {
+        const size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.resize(comment);
+        }
+        std::istringstream fields(line);
+        std::string text;
+        std::string name;
+        IPAddress address;
+        if (fields >> text >> name && IPAddress::Parse(text, address)) {
+            names->emplace(address, name);
+        }
+    }
+    return [names](const IPAddress& address, std::string& hostname) {
+        auto it = names->find(address);
+        if (it == names->end()) {
+            return false;
+        }
+        hostname = it->second;
+        return true;
+    };
+}
+
+std::shared_ptr<DnsResolver> DnsResolver::Global() {
+    auto& slot = GlobalResolver();
+    auto resolver = std::atomic_load(&slot);
+    if (!resolver) {
+        auto created = std::make_shared<DnsResolver>();
+        // A resolver that loses the race never started workers, so dropping it is free
+        if (std::atomic_compare_exchange_strong(&slot, &resolver, created)) {
+            resolver = std::move(created);
+        }
+    }
+    return resolver;
+}
+
+void DnsResolver::SetGlobal(std::shared_ptr<DnsResolver> resolver) {
+    std::atomic_store(&GlobalResolver(), std::move(resolver));
+}
@@ -0,0 +1,356 @@
+#include "DomainTrie.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+constexpr uint32_t kNoLabel = 0xFFFFFFFFu;
+constexpr size_t kInitialTableSize = 1024;
+
+inline uint64_t Mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+inline char Lower(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+inline bool IsLabelChar(char c) {
+    c = Lower(c);
+    return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' || c == '_';
+}
+
+// Case-insensitive, so lookups need not lower-case the name first
+inline uint64_t HashLabel(std::string_view label) {
+    uint64_t h = 0xCBF29CE484222325ull ^ label.size();
+    for (char c : label) {
+        h = (h ^ static_cast<uint8_t>(Lower(c))) * 0x100000001B3ull;
+    }
+    return Mix64(h);
+}
+
+inline uint64_t HashEdge(uint32_t parent, uint32_t label) {
+    return Mix64((static_cast<uint64_t>(parent) << 32) | label);
+}
+
+// `stored` is already lower case
+inline bool LabelEquals(std::string_view stored, std::string_view label) {
+    if (stored.size() != label.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < label.size(); ++i) {
+        if (Lower(label[i]) != stored[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Splits off the rightmost label of name[0, end); returns its start
+inline size_t LastLabel(std::string_view name, size_t end) {
+    const size_t dot = name.rfind('.', end - 1);
+    return dot == std::string_view::npos ? 0 : dot + 1;
+}
+
+} // namespace
+
+DomainTrie::DomainTrie()
+    : edgeCount_(0), labelCount_(0), ruleCount_(0) {
+}
+
+bool DomainTrie::ParseRule(std::string_view rule, std::string_view& name, uint32_t& flag) {
+    while (!rule.empty() && (rule.front() == ' ' || rule.front() == '\t')) rule.remove_prefix(1);
+    while (!rule.empty() && (rule.back() == ' ' || rule.back() == '\t' || rule.back() == '\r')) rule.remove_suffix(1);
+
+    flag = kBlocked;
+    if (rule.substr(0, 2) == "*.") {
+        rule.remove_prefix(2);
+        flag = kWildcard;
+    }
+    if (!rule.empty() && rule.back() == '.') {
+        rule.remove_suffix(1);
+    }
+    if (rule.empty() || rule.size() > kMaxNameLength) {
+        return false;
+    }
+
+    size_t labelLength = 0;
+    for (char c : rule) {
+        if (c == '.') {
+            if (labelLength == 0) {
+                return false;
+            }
+            labelLength = 0;
+        } else if (!IsLabelChar(c) || ++labelLength > kMaxLabelLength) {
+            return false;
+        }
+    }
+    name = rule;
+    return labelLength != 0;
+}
+
+std::string_view DomainTrie::Label(uint32_t id) const {
+    const char* text = labelPages_[id >> 16].data() + (id & 0xFFFF);
+    return std::string_view(text + 1, static_cast<uint8_t>(*text));
+}
+
+uint32_t DomainTrie::FindLabel(std::string_view label, uint64_t hash) const {
+    if (labelSlots_.empty()) {
+        return kNoLabel;
+    }
+    const size_t mask = labelSlots_.size() - 1;
+    for (size_t i = hash & mask; labelSlots_[i] != 0; i = (i + 1) & mask) {
+        if (LabelEquals(Label(labelSlots_[i] - 1), label)) {
+            return labelSlots_[i] - 1;
+        }
+    }
+    return kNoLabel;
+}
+
+uint32_t DomainTrie::InternLabel(std::string_view label) {
+    const uint64_t hash = HashLabel(label);
+    const uint32_t found = FindLabel(label, hash);
+    if (found != kNoLabel) {
+        return found;
+    }
+
+    if ((labelCount_ + 1) * 4 > labelSlots_.size() * 3) {
+        GrowLabels();
+    }
+    // Fixed-size pages: no reallocation slack, and ids stay valid
+    if (labelPages_.empty() || labelPages_.back().size() + 1 + label.size() > kLabelPageSize) {
+        labelPages_.emplace_back();
+        labelPages_.back().reserve(kLabelPageSize);
+    }
+    std::string& page = labelPages_.back();
+    const uint32_t id = static_cast<uint32_t>(((labelPages_.size() - 1) << 16) | page.size());
+    page.push_back(static_cast<char>(label.size()));
+    for (char c : label) {
+        page.push_back(Lower(c));
+    }
+    labelCount_++;
+
+    const size_t mask = labelSlots_.size() - 1;
+    size_t i = hash & mask;
+    while (labelSlots_[i] != 0) {
+        i = (i + 1) & mask;
+    }
+    labelSlots_[i] = id + 1;
+    return id;
+}
+
+void DomainTrie::GrowLabels() {
+    std::vector<uint32_t> slots(std::max(kInitialTableSize, labelSlots_.size() * 2), 0);
+    const size_t mask = slots.size() - 1;
+    for (size_t page = 0; page < labelPages_.size(); ++page) {
+        const std::string& text = labelPages_[page];
+        for (size_t offset = 0; offset < text.size(); offset += 1 + static_cast<uint8_t>(text[offset])) {
+            const uint32_t id = static_cast<uint32_t>((page << 16) | offset);
+            size_t i = HashLabel(Label(id)) & mask;
+            while (slots[i] != 0) {
+                i = (i + 1) & mask;
+            }
+            slots[i] = id + 1;
+        }
+    }
+    labelSlots_.swap(slots);
+}
+
+size_t DomainTrie::FindEdge(uint32_t parent, uint32_t label) const {
+    if (edges_.empty()) {
+        return SIZE_MAX;
+    }
+    const size_t mask = edges_.size() - 1;
+    for (size_t i = HashEdge(parent, label) & mask; edges_[i].parent != kEmpty; i = (i + 1) & mask) {
+        if (edges_[i].parent == parent && (edges_[i].label >> 2) == label) {
+            return i;
+        }
+    }
+    return SIZE_MAX;
+}
+
+size_t DomainTrie::AddEdge(uint32_t parent, uint32_t label) {
+    const size_t found = FindEdge(parent, label);
+    if (found != SIZE_MAX) {
+        return found;
+    }
+    const size_t mask = edges_.size() - 1;
+    size_t i = HashEdge(parent, label) & mask;
+    while (edges_[i].parent != kEmpty) {
+        i = (i + 1) & mask;
+    }
+    edges_[i] = Edge{parent, label << 2};
+    edgeCount_++;
+    return i;
+}
+
+void DomainTrie::GrowEdges() {
+    std::vector<Edge> old(std::max(kInitialTableSize, edges_.size() * 2), Edge{kEmpty, 0});
+    old.swap(edges_);
+    const size_t mask = edges_.size() - 1;
+
+    // Node ids are slots, so every edge moves after its parent and takes
+    // the parent's new id along; each pass moves at least one more level
+    std::vector<uint32_t> moved(old.size(), kEmpty);
+    for (size_t remaining = edgeCount_; remaining != 0;) {
+        for (size_t slot = 0; slot < old.size(); ++slot) {
+            const Edge& edge = old[slot];
+            if (edge.parent == kEmpty || moved[slot] != kEmpty) {
+                continue;
+            }
+            uint32_t parent = 0;
+            if (edge.parent != 0) {
+                if (moved[edge.parent - 1] == kEmpty) {
+                    continue;
+                }
+                parent = moved[edge.parent - 1] + 1;
+            }
+            size_t i = HashEdge(parent, edge.label >> 2) & mask;
+            while (edges_[i].parent != kEmpty) {
+                i = (i + 1) & mask;
+            }
+            edges_[i] = Edge{parent, edge.label};
+            moved[slot] = static_cast<uint32_t>(i);
+            remaining--;
+        }
+    }
+}
+
+size_t DomainTrie::FindRule(std::string_view name) const {
+    uint32_t node = 0;
+    for (size_t end = name.size();;) {
+        const size_t start = LastLabel(name, end);
+        const std::string_view label = name.substr(start, end - start);
+        const uint32_t id = FindLabel(label, HashLabel(label));
+        const size_t slot = id == kNoLabel ? SIZE_MAX : FindEdge(node, id);
+        if (slot == SIZE_MAX || start == 0) {
+            return slot;
+        }
+        node = static_cast<uint32_t>(slot + 1);
+        end = start - 1;
+    }
+}
+
+bool DomainTrie::Insert(std::string_view rule) {
+    std::string_view name;
+    uint32_t flag;
+    if (!ParseRule(rule, name, flag)) {
+        return false;
+    }
+
+    // Make room for every label first: growing renumbers the nodes
+    const size_t labels = 1 + static_cast<size_t>(std::count(name.begin(), name.end(), '.'));
+    while ((edgeCount_ + labels) * 4 > edges_.size() * 3) {
+        GrowEdges();
+    }
+
+    size_t slot;
+    uint32_t node = 0;
+    for (size_t end = name.size();;) {
+        const size_t start = LastLabel(name, end);
+        slot = AddEdge(node, InternLabel(name.substr(start, end - start)));
+        if (start == 0) {
+            break;
+        }
+        node = static_cast<uint32_t>(slot + 1);
+        end = start - 1;
+    }
+    if (edges_[slot].label & flag) {
+        return false;
+    }
+    edges_[slot].label |= flag;
+    ruleCount_++;
+    return true;
+}
+
+bool DomainTrie::Remove(std::string_view rule) {
+    std::string_view name;
+    uint32_t flag;
+    if (!ParseRule(rule, name, flag)) {
+        return false;
+    }
+    const size_t slot = FindRule(name);
+    if (slot == SIZE_MAX || !(edges_[slot].label & flag)) {
+        return false;
+    }
+    edges_[slot].label &= ~flag;
+    ruleCount_--;
+    return true;
+}
+
+void DomainTrie::Clear() {
+    *this = DomainTrie();
+}
+
+bool DomainTrie::Match(std::string_view name, std::string_view* matched) const {
+    if (!name.empty() && name.back() == '.') {
+        name.remove_suffix(1);
+    }
+    if (ruleCount_ == 0 || name.empty() || name.size() > kMaxNameLength) {
+        return false;
+    }
+
+    uint32_t node = 0;
+    for (size_t end = name.size();;) {
+        const size_t start = LastLabel(name, end);
+        const std::string_view label = name.substr(start, end - start);
+        if (label.empty() || label.size() > kMaxLabelLength) {
+            return false;
+        }
+        const uint32_t id = FindLabel(label, HashLabel(label));
+        const size_t slot = id == kNoLabel ? SIZE_MAX : FindEdge(node, id);
+        if (slot == SIZE_MAX) {
+            return false;
+        }
+
+        // A wildcard rule needs at least one more label to its left
+        const uint32_t flags = edges_[slot].label & kFlagMask;
+        if ((flags & kBlocked) || ((flags & kWildcard) && start != 0)) {
+            if (matched) {
+                *matched = name.substr(start);
+            }
+            return true;
+        }
+        if (start == 0) {
+            return false;
+        }
+        node = static_cast<uint32_t>(slot + 1);
+        end = start - 1;
+    }
+}
+
+std::vector<std::string> DomainTrie::GetRules() const {
+    std::vector<std::string> rules;
+    rules.reserve(ruleCount_);
+    std::string name;
+    for (const Edge& edge : edges_) {
+        const uint32_t flags = edge.label & kFlagMask;
+        if (edge.parent == kEmpty || flags == 0) {
+            continue;
+        }
+        // Rebuild the name from the node up through its parents
+        name.assign(Label(edge.label >> 2));
+        for (uint32_t parent = edge.parent; parent != 0; parent = edges_[parent - 1].parent) {
+            name.push_back('.');
+            name.append(Label(edges_[parent - 1].label >> 2));
+        }
+        if (flags & kBlocked) {
+            rules.push_back(name);
+        }
+        if (flags & kWildcard) {
+            rules.push_back("*." + name);
+        }
+    }
+    std::sort(rules.begin(), rules.end());
+    return rules;
+}
+
+size_t DomainTrie::GetMemoryUsage() const {
+    return edges_.capacity() * sizeof(Edge) + labelPages_.size() * kLabelPageSize +
+           labelSlots_.capacity() * sizeof(uint32_t);
+}
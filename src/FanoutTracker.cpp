@@ -0,0 +1,79 @@
+#include "FanoutTracker.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+uint64_t TargetHash(const IPAddress& target, uint16_t port) {
+    uint64_t h = target.Hash() ^ (static_cast<uint64_t>(port) * 0x9E3779B97F4A7C15ull);
+    h ^= h >> 31;
+    h *= 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 29;
+    return h;
+}
+
+} // namespace
+
+FanoutTracker::FanoutTracker(size_t maxSources, std::chrono::seconds idleTimeout)
+    : maxSources_(std::max<size_t>(maxSources, 16)), idleTimeout_(idleTimeout),
+      lastSweep_(Clock::now()) {
+}
+
+void FanoutTracker::Add(const IPAddress& source, const IPAddress& target, uint16_t targetPort,
+                        Clock::time_point now) {
+    if (sources_.size() >= maxSources_ || now - lastSweep_ > idleTimeout_ / 4) {
+        Evict(now);
+    }
+
+    Entry& entry = sources_[source];
+    entry.distinctTargets.Add(TargetHash(target, targetPort));
+    entry.lastSeen = now;
+}
+
+double FanoutTracker::Estimate(const IPAddress& source) const {
+    auto it = sources_.find(source);
+    return it == sources_.end() ? 0.0 : it->second.distinctTargets.Estimate();
+}
+
+void FanoutTracker::Clear() {
+    sources_.clear();
+}
+
+size_t FanoutTracker::GetMemoryUsage() const {
+    // Approximate node cost of the hash table plus each sketch's storage
+    size_t total = sources_.bucket_count() * sizeof(void*);
+    for (const auto& pair : sources_) {
+        total += sizeof(pair) + 2 * sizeof(void*) + pair.second.distinctTargets.GetMemoryUsage();
+    }
+    return total;
+}
+
+void FanoutTracker::Evict(Clock::time_point now) {
+    lastSweep_ = now;
+    for (auto it = sources_.begin(); it != sources_.end();) {
+        if (now - it->second.lastSeen > idleTimeout_) {
+            it = sources_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // Still full (e.g. a spoofed-source flood): drop the least recently seen 10%
+    if (sources_.size() >= maxSources_) {
+        std::vector<Clock::time_point> seen;
+        seen.reserve(sources_.size());
+        for (const auto& pair : sources_) {
+            seen.push_back(pair.second.lastSeen);
+        }
+        size_t cut = sources_.size() / 10;
+        std::nth_element(seen.begin(), seen.begin() + cut, seen.end());
+        Clock::time_point cutoff = seen[cut];
+        for (auto it = sources_.begin(); it != sources_.end();) {
+            if (it->second.lastSeen < cutoff) {
+                it = sources_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
@@ -0,0 +1,290 @@
+#include "FlowTable.h"
+#include <algorithm>
+
+namespace {
+
+// Keep probe sequences short: grow the index past 7/8 occupancy
+constexpr size_t kInitialIndexSize = 1024;
+
+inline uint64_t Mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+} // namespace
+
+FlowTable::Key FlowTable::Key::Make(const IPAddress& source, uint16_t sourcePort,
+                                    const IPAddress& destination, uint16_t destinationPort,
+                                    uint8_t protocol) {
+    Key key;
+    key.source = source;
+    key.destination = destination;
+    key.sourcePort = sourcePort;
+    key.destinationPort = destinationPort;
+    key.protocol = protocol;
+    return key;
+}
+
+FlowTable::Key FlowTable::Key::Reversed() const {
+    return Make(destination, destinationPort, source, sourcePort, protocol);
+}
+
+uint64_t FlowTable::Key::Hash() const {
+    uint64_t h = source.Hash() * 0x9E3779B97F4A7C15ull;
+    h ^= destination.Hash() + 0x632BE59BD9B4E019ull + (h << 6) + (h >> 2);
+    h ^= (static_cast<uint64_t>(sourcePort) << 24) | (static_cast<uint64_t>(destinationPort) << 8) | protocol;
+    return Mix64(h);
+}
+
+bool FlowTable::Key::operator==(const Key& other) const {
+    return sourcePort == other.sourcePort && destinationPort == other.destinationPort &&
+           protocol == other.protocol && source == other.source && destination == other.destination;
+}
+
+FlowTable::FlowTable(size_t maxFlows, std::chrono::seconds idleTimeout)
+    : maxFlows_(std::min<size_t>(std::max<size_t>(maxFlows, 1), 0xFFFFFFF0u)),
+      idleTimeout_(static_cast<uint32_t>(std::max<int64_t>(idleTimeout.count(), 1))),
+      mask_(0), size_(0), allocated_(0), freeList_(0), wheelTick_(0),
+      totalCreated_(0), dropped_(0) {
+    std::fill(wheel_, wheel_ + kWheelSlots, 0u);
+}
+
+uint32_t FlowTable::ToSeconds(Clock::time_point time) {
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count());
+}
+
+FlowTable::Flow* FlowTable::Update(const Key& key, uint32_t bytes, uint8_t tcpFlags, Clock::time_point now,
+                                   bool& created, bool* reverse) {
+    created = false;
+    const uint32_t seconds = ToSeconds(now);
+    if (wheelTick_ == 0) {
+        wheelTick_ = seconds;
+    }
+
+    int direction = 0;
+    uint64_t hash = key.Hash();
+    size_t slot = FindSlot(key, static_cast<uint32_t>(hash));
+    if (slot == index_.size()) {
+        const Key reversed = key.Reversed();
+        const uint64_t reversedHash = reversed.Hash();
+        slot = FindSlot(reversed, static_cast<uint32_t>(reversedHash));
+        if (slot != index_.size()) {
+            direction = 1;
+        }
+    }
+
+    Flow* flow;
+    if (slot != index_.size()) {
+        flow = &FlowAt(index_[slot].flow - 1);
+    } else {
+        if (size_ >= maxFlows_) {
+            dropped_++;
+            return nullptr;
+        }
+        if ((size_ + 1) * 8 > index_.size() * 7) {
+            Grow();
+        }
+        const uint32_t id = AllocateFlow();
+        flow = &FlowAt(id);
+        flow->key = key;
+        flow->bytes[0] = flow->bytes[1] = 0;
+        flow->packets[0] = flow->packets[1] = 0;
+        flow->firstSeen = seconds;
+        flow->lastSeen = seconds;
+        flow->state = 0;
+        flow->tcpFlags = 0;
+        flow->payloadTag = 0;
+        flow->payloadState[0] = flow->payloadState[1] = 0;
+        InsertIndex(id, static_cast<uint32_t>(hash));
+        Schedule(id);
+        size_++;
+        totalCreated_++;
+        created = true;
+    }
+
+    flow->bytes[direction] += bytes;
+    if (bytes || tcpFlags) {
+        flow->packets[direction]++;
+    }
+    flow->tcpFlags |= tcpFlags;
+    // Timestamps from replayed captures may arrive slightly out of order
+    if (seconds > flow->lastSeen) {
+        flow->lastSeen = seconds;
+    }
+    if (reverse) {
+        *reverse = direction != 0;
+    }
+    return flow;
+}
+
+const FlowTable::Flow* FlowTable::Find(const Key& key) const {
+    size_t slot = FindSlot(key, static_cast<uint32_t>(key.Hash()));
+    if (slot == index_.size()) {
+        const Key reversed = key.Reversed();
+        slot = FindSlot(reversed, static_cast<uint32_t>(reversed.Hash()));
+    }
+    return slot == index_.size() ? nullptr : &FlowAt(index_[slot].flow - 1);
+}
+
+size_t FlowTable::FindSlot(const Key& key, uint32_t hash) const {
+    if (index_.empty()) {
+        return 0;
+    }
+    size_t slot = hash & mask_;
+    for (size_t distance = 0;; ++distance) {
+        const IndexEntry& entry = index_[slot];
+        if (!entry.flow) {
+            return index_.size();
+        }
+        // Robin-hood invariant: a richer entry means the key cannot be further along
+        if (((slot - (entry.hash & mask_)) & mask_) < distance) {
+            return index_.size();
+        }
+        if (entry.hash == hash && FlowAt(entry.flow - 1).key == key) {
+            return slot;
+        }
+        slot = (slot + 1) & mask_;
+    }
+}
+
+void FlowTable::InsertIndex(uint32_t id, uint32_t hash) {
+    IndexEntry incoming{id + 1, hash};
+    size_t slot = hash & mask_;
+    size_t distance = 0;
+    for (;;) {
+        IndexEntry& entry = index_[slot];
+        if (!entry.flow) {
+            entry = incoming;
+            return;
+        }
+        const size_t existing = (slot - (entry.hash & mask_)) & mask_;
+        if (existing < distance) {
+            std::swap(entry, incoming);
+            distance = existing;
+        }
+        slot = (slot + 1) & mask_;
+        ++distance;
+    }
+}
+
+void FlowTable::EraseIndex(size_t slot) {
+    // Backward-shift deletion keeps probe sequences tombstone-free
+    size_t next = (slot + 1) & mask_;
+    while (index_[next].flow && ((next - (index_[next].hash & mask_)) & mask_) != 0) {
+        index_[slot] = index_[next];
+        slot = next;
+        next = (next + 1) & mask_;
+    }
+    index_[slot] = IndexEntry{0, 0};
+}
+
+void FlowTable::Grow() {
+    std::vector<IndexEntry> old;
+    old.swap(index_);
+    const size_t size = old.empty() ? kInitialIndexSize : old.size() * 2;
+    index_.assign(size, IndexEntry{0, 0});
+    mask_ = size - 1;
+    for (const IndexEntry& entry : old) {
+        if (entry.flow) {
+            InsertIndex(entry.flow - 1, entry.hash);
+        }
+    }
+}
+
+uint32_t FlowTable::AllocateFlow() {
+    if (freeList_) {
+        const uint32_t id = freeList_ - 1;
+        freeList_ = FlowAt(id).timerNext;
+        return id;
+    }
+    if ((allocated_ >> kChunkBits) >= chunks_.size()) {
+        chunks_.emplace_back(new Flow[kChunkSize]);
+    }
+    return allocated_++;
+}
+
+void FlowTable::Schedule(uint32_t id) {
+    Flow& flow = FlowAt(id);
+    const size_t slot = Deadline(flow) & (kWheelSlots - 1);
+    flow.timerNext = wheel_[slot];
+    wheel_[slot] = id + 1;
+}
+
+void FlowTable::Remove(uint32_t id) {
+    Flow& flow = FlowAt(id);
+    const size_t slot = FindSlot(flow.key, static_cast<uint32_t>(flow.key.Hash()));
+    if (slot != index_.size()) {
+        EraseIndex(slot);
+    }
+    flow.timerNext = freeList_;
+    freeList_ = id + 1;
+    size_--;
+}
+
+size_t FlowTable::ProcessSlot(size_t slot, uint32_t now, const ExpireCallback& onExpired) {
+    uint32_t link = wheel_[slot];
+    wheel_[slot] = 0;
+
+    size_t expired = 0;
+    while (link) {
+        const uint32_t id = link - 1;
+        Flow& flow = FlowAt(id);
+        link = flow.timerNext;
+
+        if (Deadline(flow) <= now) {
+            if (onExpired) {
+                onExpired(flow);
+            }
+            Remove(id);
+            ++expired;
+        } else {
+            Schedule(id); // touched since it was filed; move to its current deadline
+        }
+    }
+    return expired;
+}
+
+size_t FlowTable::Expire(Clock::time_point now, const ExpireCallback& onExpired) {
+    const uint32_t seconds = ToSeconds(now);
+    if (wheelTick_ == 0) {
+        wheelTick_ = seconds;
+        return 0;
+    }
+    if (seconds <= wheelTick_) {
+        return 0;
+    }
+
+    size_t expired = 0;
+    if (seconds - wheelTick_ >= kWheelSlots) {
+        // Asleep for a full lap: every slot is due, check them all once
+        for (size_t slot = 0; slot < kWheelSlots; ++slot) {
+            expired += ProcessSlot(slot, seconds, onExpired);
+        }
+    } else {
+        for (uint32_t tick = wheelTick_ + 1; tick <= seconds; ++tick) {
+            expired += ProcessSlot(tick & (kWheelSlots - 1), tick, onExpired);
+        }
+    }
+    wheelTick_ = seconds;
+    return expired;
+}
+
+void FlowTable::Clear() {
+    index_.clear();
+    index_.shrink_to_fit();
+    chunks_.clear();
+    mask_ = 0;
+    size_ = 0;
+    allocated_ = 0;
+    freeList_ = 0;
+    std::fill(wheel_, wheel_ + kWheelSlots, 0u);
+    wheelTick_ = 0;
+}
+
+size_t FlowTable::GetMemoryUsage() const {
+    return index_.capacity() * sizeof(IndexEntry) + chunks_.size() * kChunkSize * sizeof(Flow) + sizeof(*this);
+}
@@ -0,0 +1,117 @@
+#include "HyperLogLog.h"
+#include <cmath>
+#include <cstddef>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+// Sparse entries cost 2 bytes each; past this many the dense form is smaller
+// once vector growth slack is taken into account
+constexpr size_t kSparseLimit = HyperLogLog::kRegisters / 4;
+
+inline int CountLeadingZeros64(uint64_t x) {
+#ifdef _MSC_VER
+    unsigned long index;
+    return _BitScanReverse64(&index, x) ? 63 - static_cast<int>(index) : 64;
+#else
+    return x ? __builtin_clzll(x) : 64;
+#endif
+}
+
+inline uint16_t MakeEntry(uint32_t index, uint8_t rank) {
+    return static_cast<uint16_t>((index << 6) | rank);
+}
+
+} // namespace
+
+uint16_t HyperLogLog::SparseEntry(size_t i) const {
+    return static_cast<uint16_t>((storage_[i * 2] << 8) | storage_[i * 2 + 1]);
+}
+
+void HyperLogLog::Add(uint64_t hash) {
+    const uint32_t index = static_cast<uint32_t>(hash >> (64 - kPrecision));
+    // Rank of the first set bit in the remaining bits; the sentinel bit caps it at 64 - p + 1
+    const uint64_t rest = (hash << kPrecision) | (1ull << (kPrecision - 1));
+    const uint8_t rank = static_cast<uint8_t>(CountLeadingZeros64(rest) + 1);
+
+    if (dense_) {
+        if (storage_[index] < rank) {
+            storage_[index] = rank;
+        }
+        return;
+    }
+
+    // Binary search the sorted sparse list by register index
+    size_t lo = 0, hi = SparseCount();
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if ((SparseEntry(mid) >> 6) < index) lo = mid + 1;
+        else hi = mid;
+    }
+
+    if (lo < SparseCount() && (SparseEntry(lo) >> 6) == index) {
+        if ((SparseEntry(lo) & 0x3F) < rank) {
+            uint16_t entry = MakeEntry(index, rank);
+            storage_[lo * 2] = static_cast<uint8_t>(entry >> 8);
+            storage_[lo * 2 + 1] = static_cast<uint8_t>(entry);
+        }
+        return;
+    }
+
+    if (SparseCount() >= kSparseLimit) {
+        ConvertToDense();
+        storage_[index] = rank;
+        return;
+    }
+
+    uint16_t entry = MakeEntry(index, rank);
+    const uint8_t bytes[2] = {static_cast<uint8_t>(entry >> 8), static_cast<uint8_t>(entry)};
+    storage_.insert(storage_.begin() + static_cast<std::ptrdiff_t>(lo * 2), bytes, bytes + 2);
+}
+
+double HyperLogLog::Estimate() const {
+    const double m = static_cast<double>(kRegisters);
+    const double alpha = 0.7213 / (1.0 + 1.079 / m);
+
+    double sum = 0.0;
+    size_t zeros = 0;
+    if (dense_) {
+        for (size_t i = 0; i < kRegisters; ++i) {
+            sum += std::ldexp(1.0, -storage_[i]);
+            if (storage_[i] == 0) ++zeros;
+        }
+    } else {
+        const size_t count = SparseCount();
+        zeros = kRegisters - count;
+        sum = static_cast<double>(zeros);
+        for (size_t i = 0; i < count; ++i) {
+            sum += std::ldexp(1.0, -(SparseEntry(i) & 0x3F));
+        }
+    }
+
+    double estimate = alpha * m * m / sum;
+    // Small-range correction: linear counting is far more accurate here
+    if (estimate <= 2.5 * m && zeros > 0) {
+        estimate = m * std::log(m / static_cast<double>(zeros));
+    }
+    return estimate;
+}
+
+void HyperLogLog::Clear() {
+    storage_.clear();
+    storage_.shrink_to_fit();
+    dense_ = false;
+}
+
+void HyperLogLog::ConvertToDense() {
+    std::vector<uint8_t> registers(kRegisters, 0);
+    for (size_t i = 0; i < SparseCount(); ++i) {
+        uint16_t entry = SparseEntry(i);
+        registers[entry >> 6] = static_cast<uint8_t>(entry & 0x3F);
+    }
+    storage_.swap(registers);
+    dense_ = true;
+}
@@ -0,0 +1,344 @@
+#include "IPAddress.h"
+#include <type_traits>
+
+static_assert(sizeof(IPAddress) == 16, "IPAddress must stay 16 bytes");
+static_assert(std::is_trivially_copyable<IPAddress>::value, "IPAddress must be trivially copyable");
+
+namespace {
+
+const uint8_t kMappedPrefix[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff};
+
+// Hex digit values, 0xFF for anything else; one load instead of three range tests
+struct HexTable {
+    uint8_t values[256];
+
+    constexpr HexTable() : values() {
+        for (int i = 0; i < 256; ++i) values[i] = 0xFF;
+        for (int i = 0; i < 10; ++i) values['0' + i] = static_cast<uint8_t>(i);
+        for (int i = 0; i < 6; ++i) values['a' + i] = values['A' + i] = static_cast<uint8_t>(10 + i);
+    }
+};
+constexpr HexTable kHexTable;
+
+inline int HexValue(char c) {
+    const uint8_t value = kHexTable.values[static_cast<uint8_t>(c)];
+    return value == 0xFF ? -1 : value;
+}
+
+bool ParseIPv4Text(const char* p, const char* end, uint8_t* out) {
+    for (int part = 0; part < 4; ++part) {
+        if (part) {
+            if (p >= end || *p != '.') return false;
+            ++p;
+        }
+        unsigned value = 0;
+        int digits = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (++digits > 3) return false;
+            value = value * 10 + static_cast<unsigned>(*p - '0');
+            ++p;
+        }
+        if (digits == 0 || value > 255) return false;
+        out[part] = static_cast<uint8_t>(value);
+    }
+    return p == end;
+}
+
+bool ParseIPv6Text(const char* p, const char* end, uint8_t* out) {
+    uint16_t groups[8];
+    int count = 0;
+    int compressAt = -1;
+
+    if (end - p >= 2 && p[0] == ':' && p[1] == ':') {
+        compressAt = 0;
+        p += 2;
+    } else if (p < end && *p == ':') {
+        return false;
+    }
+
+    while (p < end) {
+        if (count == 8) return false;
+
+        const char* groupStart = p;
+        unsigned value = 0;
+        int digits = 0;
+        int h;
+        while (p < end && digits < 5 && (h = HexValue(*p)) >= 0) {
+            value = (value << 4) | static_cast<unsigned>(h);
+            ++digits;
+            ++p;
+        }
+
+        if (p < end && *p == '.') {
+            // Trailing embedded IPv4 ("::ffff:1.2.3.4") fills the last two groups
+            uint8_t v4[4];
+            if (count > 6 || !ParseIPv4Text(groupStart, end, v4)) return false;
+            groups[count++] = static_cast<uint16_t>((v4[0] << 8) | v4[1]);
+            groups[count++] = static_cast<uint16_t>((v4[2] << 8) | v4[3]);
+            p = end;
+            break;
+        }
+
+        if (digits == 0 || digits > 4) return false;
+        groups[count++] = static_cast<uint16_t>(value);
+
+        if (p == end) break;
+        if (*p != ':') return false;
+        ++p;
+        if (p < end && *p == ':') {
+            if (compressAt >= 0) return false;
+            compressAt = count;
+            ++p;
+        } else if (p == end) {
+            return false;
+        }
+    }
+
+    if (compressAt < 0) {
+        if (count != 8) return false;
+    } else if (count > 7) {
+        return false;
+    }
+
+    int zeros = 8 - count;
+    int src = 0;
+    for (int dst = 0; dst < 8; ++dst) {
+        uint16_t g;
+        if (compressAt >= 0 && dst >= compressAt && dst < compressAt + zeros) {
+            g = 0;
+        } else {
+            g = groups[src++];
+        }
+        out[dst * 2] = static_cast<uint8_t>(g >> 8);
+        out[dst * 2 + 1] = static_cast<uint8_t>(g);
+    }
+    return true;
+}
+
+char* FormatDecimal(char* out, unsigned value) {
+    if (value >= 100) {
+        *out++ = static_cast<char>('0' + value / 100);
+        value %= 100;
+        *out++ = static_cast<char>('0' + value / 10);
+        *out++ = static_cast<char>('0' + value % 10);
+    } else if (value >= 10) {
+        *out++ = static_cast<char>('0' + value / 10);
+        *out++ = static_cast<char>('0' + value % 10);
+    } else {
+        *out++ = static_cast<char>('0' + value);
+    }
+    return out;
+}
+
+char* FormatIPv4(char* out, const uint8_t* bytes) {
+    for (int i = 0; i < 4; ++i) {
+        if (i) *out++ = '.';
+        out = FormatDecimal(out, bytes[i]);
+    }
+    return out;
+}
+
+// RFC 5952 text form: lowercase, longest zero run (2+ groups) compressed
+char* FormatIPv6(char* out, const uint8_t* bytes) {
+    uint16_t groups[8];
+    for (int i = 0; i < 8; ++i) {
+        groups[i] = static_cast<uint16_t>((bytes[i * 2] << 8) | bytes[i * 2 + 1]);
+    }
+
+    int bestStart = -1, bestLen = 1;
+    for (int i = 0; i < 8;) {
+        if (groups[i] != 0) { ++i; continue; }
+        int j = i;
+        while (j < 8 && groups[j] == 0) ++j;
+        if (j - i > bestLen) {
+            bestStart = i;
+            bestLen = j - i;
+        }
+        i = j;
+    }
+
+    static const char kHex[] = "0123456789abcdef";
+    for (int i = 0; i < 8; ++i) {
+        if (i == bestStart) {
+            *out++ = ':';
+            if (i == 0) *out++ = ':';
+            i += bestLen - 1;
+            continue;
+        }
+        uint16_t g = groups[i];
+        bool started = false;
+        for (int shift = 12; shift >= 0; shift -= 4) {
+            unsigned nibble = (g >> shift) & 0xF;
+            if (nibble || started || shift == 0) {
+                *out++ = kHex[nibble];
+                started = true;
+            }
+        }
+        if (i != 7) *out++ = ':';
+    }
+    return out;
+}
+
+} // namespace
+
+IPAddress IPAddress::FromIPv4(uint32_t hostOrder) {
+    uint8_t bytes[4] = {
+        static_cast<uint8_t>(hostOrder >> 24), static_cast<uint8_t>(hostOrder >> 16),
+        static_cast<uint8_t>(hostOrder >> 8), static_cast<uint8_t>(hostOrder)
+    };
+    return FromIPv4Bytes(bytes);
+}
+
+IPAddress IPAddress::FromIPv4Bytes(const uint8_t* networkOrder) {
+    IPAddress address;
+    std::memcpy(address.MutableBytes(), kMappedPrefix, sizeof(kMappedPrefix));
+    std::memcpy(address.MutableBytes() + 12, networkOrder, 4);
+    return address;
+}
+
+IPAddress IPAddress::FromIPv6Bytes(const uint8_t* networkOrder) {
+    IPAddress address;
+    std::memcpy(address.MutableBytes(), networkOrder, 16);
+    return address;
+}
+
+bool IPAddress::Parse(std::string_view text, IPAddress& out) {
+    const char* p = text.data();
+    const char* end = p + text.size();
+    if (text.empty() || text.size() > kMaxTextLength) {
+        return false;
+    }
+
+    uint8_t bytes[16];
+    if (std::memchr(p, ':', text.size())) {
+        if (!ParseIPv6Text(p, end, bytes)) return false;
+        out = FromIPv6Bytes(bytes);
+        return true;
+    }
+
+    if (!ParseIPv4Text(p, end, bytes)) return false;
+    out = FromIPv4Bytes(bytes);
+    return true;
+}
+
+bool IPAddress::ParseIPv4(std::string_view text, IPAddress& out) {
+    uint8_t bytes[4];
+    if (text.empty() || !ParseIPv4Text(text.data(), text.data() + text.size(), bytes)) {
+        return false;
+    }
+    out = FromIPv4Bytes(bytes);
+    return true;
+}
+
+bool IPAddress::ParseIPv6(std::string_view text, IPAddress& out) {
+    uint8_t bytes[16];
+    if (text.size() < 2 || text.size() > kMaxTextLength ||
+        !ParseIPv6Text(text.data(), text.data() + text.size(), bytes)) {
+        return false;
+    }
+    out = FromIPv6Bytes(bytes);
+    return true;
+}
+
+IPAddress IPAddress::FromString(std::string_view text) {
+    IPAddress address;
+    Parse(text, address);
+    return address;
+}
+
+bool IPAddress::IsIPv4() const {
+    return std::memcmp(Bytes(), kMappedPrefix, sizeof(kMappedPrefix)) == 0;
+}
+
+uint32_t IPAddress::ToIPv4() const {
+    const uint8_t* b = Bytes() + 12;
+    return (static_cast<uint32_t>(b[0]) << 24) | (static_cast<uint32_t>(b[1]) << 16) |
+           (static_cast<uint32_t>(b[2]) << 8) | static_cast<uint32_t>(b[3]);
+}
+
+IPAddress::Scope IPAddress::Classify() const {
+    const uint8_t* b = Bytes();
+    if (IsIPv4()) {
+        b += 12;
+        switch (b[0]) {
+        case 0:
+            return ToIPv4() == 0 ? Scope::Unspecified : Scope::Reserved;
+        case 10:
+            return Scope::Private;
+        case 100:
+            return (b[1] & 0xC0) == 64 ? Scope::SharedCgnat : Scope::Global;
+        case 127:
+            return Scope::Loopback;
+        case 169:
+            return b[1] == 254 ? Scope::LinkLocal : Scope::Global;
+        case 172:
+            return (b[1] & 0xF0) == 16 ? Scope::Private : Scope::Global;
+        case 192:
+            if (b[1] == 168) return Scope::Private;
+            if (b[1] == 0 && b[2] == 2) return Scope::Documentation;
+            if (b[1] == 0 && b[2] == 0) return Scope::Reserved;
+            return Scope::Global;
+        case 198:
+            if (b[1] == 51 && b[2] == 100) return Scope::Documentation;
+            if ((b[1] & 0xFE) == 18) return Scope::Reserved;
+            return Scope::Global;
+        case 203:
+            return b[1] == 0 && b[2] == 113 ? Scope::Documentation : Scope::Global;
+        default:
+            if (b[0] >= 240) return ToIPv4() == 0xFFFFFFFFu ? Scope::Broadcast : Scope::Reserved;
+            if (b[0] >= 224) return Scope::Multicast;
+            return Scope::Global;
+        }
+    }
+
+    switch (b[0]) {
+    case 0x00:
+        // The mapped range is handled above, so only ::, ::1 and deprecated forms remain
+        if (words_[0] == 0 && std::memcmp(b + 8, "\0\0\0\0\0\0\0", 7) == 0) {
+            if (b[15] == 0) return Scope::Unspecified;
+            if (b[15] == 1) return Scope::Loopback;
+        }
+        return Scope::Reserved;
+    case 0x20:
+        return b[1] == 0x01 && b[2] == 0x0D && b[3] == 0xB8 ? Scope::Documentation : Scope::Global;
+    case 0x3F:
+        return b[1] == 0xFF && (b[2] & 0xF0) == 0 ? Scope::Documentation : Scope::Global;
+    case 0xFC:
+    case 0xFD:
+        return Scope::Private;
+    case 0xFE:
+        if ((b[1] & 0xC0) == 0x80) return Scope::LinkLocal;
+        if ((b[1] & 0xC0) == 0xC0) return Scope::Reserved;
+        return Scope::Global;
+    case 0xFF:
+        return Scope::Multicast;
+    default:
+        return Scope::Global;
+    }
+}
+
+const char* IPAddress::GetScopeName(Scope scope) {
+    switch (scope) {
+    case Scope::Global: return "global";
+    case Scope::Unspecified: return "unspecified";
+    case Scope::Loopback: return "loopback";
+    case Scope::Private: return "private";
+    case Scope::LinkLocal: return "link-local";
+    case Scope::SharedCgnat: return "shared (CGNAT)";
+    case Scope::Multicast: return "multicast";
+    case Scope::Documentation: return "documentation";
+    case Scope::Broadcast: return "broadcast";
+    case Scope::Reserved: return "reserved";
+    }
+    return "unknown";
+}
+
+size_t IPAddress::Format(char* out) const {
+    char* end = IsIPv4() ? FormatIPv4(out, Bytes() + 12) : FormatIPv6(out, Bytes());
+    return static_cast<size_t>(end - out);
+}
+
+std::string IPAddress::ToString() const {
+    char text[kMaxTextLength];
+    return std::string(text, Format(text));
+}
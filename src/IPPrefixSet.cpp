@@ -0,0 +1,467 @@
+#include "IPPrefixSet.h"
+#include <algorithm>
+#include <unordered_set>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+constexpr uint32_t kNil = 0xFFFFFFFFu;
+constexpr uint8_t kNoMatch = 0xFF;
+
+inline int CountLeadingZeros32(uint32_t x) {
+#ifdef _MSC_VER
+    unsigned long index;
+    return _BitScanReverse(&index, x) ? 31 - static_cast<int>(index) : 32;
+#else
+    return x ? __builtin_clz(x) : 32;
+#endif
+}
+
+inline int CountLeadingZeros64(uint64_t x) {
+#ifdef _MSC_VER
+    unsigned long index;
+    return _BitScanReverse64(&index, x) ? 63 - static_cast<int>(index) : 64;
+#else
+    return x ? __builtin_clzll(x) : 64;
+#endif
+}
+
+inline uint64_t LoadBigEndian64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v = (v << 8) | p[i];
+    return v;
+}
+
+inline void StoreBigEndian64(uint8_t* p, uint64_t v) {
+    for (int i = 7; i >= 0; --i) {
+        p[i] = static_cast<uint8_t>(v);
+        v >>= 8;
+    }
+}
+
+} // namespace
+
+// Bit-level operations for each key type; bit 0 is the most significant bit
+template <typename Key>
+struct KeyTraits;
+
+template <>
+struct KeyTraits<uint32_t> {
+    static constexpr int kBits = 32;
+    // IPv4 feeds are dense, so a wider first level keeps the tries shallow
+    static constexpr int kRootBits = 20;
+
+    static uint32_t Top(uint32_t k) { return k >> (32 - kRootBits); }
+    static int Bit(uint32_t k, int i) { return static_cast<int>((k >> (31 - i)) & 1u); }
+    static uint32_t Mask(uint32_t k, int len) { return len == 0 ? 0 : k & (0xFFFFFFFFu << (32 - len)); }
+    static int CommonPrefix(uint32_t a, uint32_t b) { return CountLeadingZeros32(a ^ b); }
+    static uint32_t FromTop(uint32_t top) { return top << (32 - kRootBits); }
+};
+
+template <typename Key128>
+struct KeyTraits128 {
+    static constexpr int kBits = 128;
+    static constexpr int kRootBits = 16;
+
+    static uint32_t Top(const Key128& k) { return static_cast<uint32_t>(k.hi >> (64 - kRootBits)); }
+    static int Bit(const Key128& k, int i) {
+        return i < 64 ? static_cast<int>((k.hi >> (63 - i)) & 1u)
+                      : static_cast<int>((k.lo >> (127 - i)) & 1u);
+    }
+    static Key128 Mask(const Key128& k, int len) {
+        if (len == 0) return Key128{0, 0};
+        if (len < 64) return Key128{k.hi & (~0ull << (64 - len)), 0};
+        if (len == 64) return Key128{k.hi, 0};
+        if (len < 128) return Key128{k.hi, k.lo & (~0ull << (128 - len))};
+        return k;
+    }
+    static int CommonPrefix(const Key128& a, const Key128& b) {
+        if (a.hi != b.hi) return CountLeadingZeros64(a.hi ^ b.hi);
+        return 64 + CountLeadingZeros64(a.lo ^ b.lo);
+    }
+    static Key128 FromTop(uint32_t top) { return Key128{static_cast<uint64_t>(top) << (64 - kRootBits), 0}; }
+};
+
+template <typename Key>
+class IPPrefixSet::Trie {
+    using Traits = typename std::conditional<std::is_same<Key, uint32_t>::value,
+                                             KeyTraits<uint32_t>, KeyTraits128<Key>>::type;
+    static constexpr int kRootBits = Traits::kRootBits;
+    static constexpr uint32_t kRootSlots = 1u << kRootBits;
+
+    struct Node {
+        Key key;
+        uint32_t child[2];
+        uint8_t length;
+        uint8_t terminal;
+    };
+
+public:
+    Trie() : freeList_(kNil), size_(0) {}
+
+    bool Insert(Key key, int len) {
+        if (roots_.empty()) {
+            // First-level tables are allocated on first use so empty sets stay small
+            roots_.assign(kRootSlots, kNil);
+            shortBest_.assign(kRootSlots, kNoMatch);
+        }
+        key = Traits::Mask(key, len);
+        if (len < kRootBits) {
+            return InsertShort(key, len);
+        }
+
+        const uint32_t slot = Traits::Top(key);
+        uint32_t parent = kNil;
+        int dir = 0;
+        uint32_t idx = roots_[slot];
+
+        for (;;) {
+            if (idx == kNil) {
+                uint32_t leaf = Allocate(key, len, true);
+                Reference(slot, parent, dir) = leaf;
+                ++size_;
+                return true;
+            }
+
+            const Key nodeKey = nodes_[idx].key;
+            const int nodeLen = nodes_[idx].length;
+            const int common = std::min({Traits::CommonPrefix(nodeKey, key), nodeLen, len});
+
+            if (common == nodeLen) {
+                if (len == nodeLen) {
+                    if (nodes_[idx].terminal) return false;
+                    nodes_[idx].terminal = 1;
+                    ++size_;
+                    return true;
+                }
+                parent = idx;
+                dir = Traits::Bit(key, nodeLen);
+                idx = nodes_[idx].child[dir];
+                continue;
+            }
+
+            // The new prefix diverges inside this node's compressed path
+            if (common == len) {
+                uint32_t inserted = Allocate(key, len, true);
+                nodes_[inserted].child[Traits::Bit(nodeKey, len)] = idx;
+                Reference(slot, parent, dir) = inserted;
+            } else {
+                uint32_t branch = Allocate(Traits::Mask(key, common), common, false);
+                uint32_t leaf = Allocate(key, len, true);
+                nodes_[branch].child[Traits::Bit(key, common)] = leaf;
+                nodes_[branch].child[Traits::Bit(nodeKey, common)] = idx;
+                Reference(slot, parent, dir) = branch;
+            }
+            ++size_;
+            return true;
+        }
+    }
+
+    bool Remove(Key key, int len) {
+        if (roots_.empty()) {
+            return false;
+        }
+        key = Traits::Mask(key, len);
+        if (len < kRootBits) {
+            return RemoveShort(key, len);
+        }
+
+        const uint32_t slot = Traits::Top(key);
+        // Path of (parent, direction) pairs so empty nodes can be unlinked
+        uint32_t parents[Traits::kBits + 2];
+        int dirs[Traits::kBits + 2];
+        int depth = 0;
+        uint32_t parent = kNil;
+        int dir = 0;
+        uint32_t idx = roots_[slot];
+
+        while (idx != kNil) {
+            const Node& node = nodes_[idx];
+            if (node.length > len || Traits::CommonPrefix(node.key, key) < node.length) {
+                return false;
+            }
+            if (node.length == len) break;
+            parents[depth] = parent;
+            dirs[depth] = dir;
+            ++depth;
+            parent = idx;
+            dir = Traits::Bit(key, node.length);
+            idx = node.child[dir];
+        }
+        if (idx == kNil || !nodes_[idx].terminal) {
+            return false;
+        }
+
+        nodes_[idx].terminal = 0;
+        --size_;
+
+        // Collapse nodes that no longer carry a prefix or a branch
+        for (;;) {
+            Node& node = nodes_[idx];
+            if (node.terminal || (node.child[0] != kNil && node.child[1] != kNil)) break;
+
+            uint32_t onlyChild = node.child[0] != kNil ? node.child[0] : node.child[1];
+            Reference(slot, parent, dir) = onlyChild;
+            Release(idx);
+            if (onlyChild != kNil || parent == kNil) break;
+
+            idx = parent;
+            --depth;
+            parent = parents[depth];
+            dir = dirs[depth];
+        }
+        return true;
+    }
+
+    int LongestMatch(const Key& key) const {
+        if (roots_.empty()) {
+            return -1;
+        }
+        const uint32_t slot = Traits::Top(key);
+        int best = shortBest_[slot] == kNoMatch ? -1 : shortBest_[slot];
+
+        uint32_t idx = roots_[slot];
+        while (idx != kNil) {
+            const Node& node = nodes_[idx];
+            if (Traits::CommonPrefix(node.key, key) < node.length) break;
+            if (node.terminal) best = node.length;
+            if (node.length == Traits::kBits) break;
+            idx = node.child[Traits::Bit(key, node.length)];
+        }
+        return best;
+    }
+
+    void Clear() {
+        roots_.clear();
+        roots_.shrink_to_fit();
+        shortBest_.clear();
+        shortBest_.shrink_to_fit();
+        nodes_.clear();
+        nodes_.shrink_to_fit();
+        shortPrefixes_.clear();
+        freeList_ = kNil;
+        size_ = 0;
+    }
+
+    size_t Size() const { return size_; }
+
+    template <typename Visitor>
+    void ForEach(Visitor&& visit) const {
+        std::vector<std::pair<uint32_t, int>> shorts;
+        for (uint32_t packed : shortPrefixes_) {
+            shorts.emplace_back(packed & kTopMask, static_cast<int>(packed >> 24));
+        }
+        std::sort(shorts.begin(), shorts.end());
+        for (const auto& entry : shorts) {
+            visit(Traits::FromTop(entry.first), entry.second);
+        }
+
+        std::vector<uint32_t> stack;
+        for (uint32_t slot = 0; slot < roots_.size(); ++slot) {
+            if (roots_[slot] == kNil) continue;
+            stack.push_back(roots_[slot]);
+            while (!stack.empty()) {
+                const Node& node = nodes_[stack.back()];
+                stack.pop_back();
+                if (node.terminal) visit(node.key, node.length);
+                if (node.child[1] != kNil) stack.push_back(node.child[1]);
+                if (node.child[0] != kNil) stack.push_back(node.child[0]);
+            }
+        }
+    }
+
+private:
+    std::vector<uint32_t> roots_;       // trie root per first-level slot
+    std::vector<uint8_t> shortBest_;    // longest prefix shorter than kRootBits covering each slot
+    std::unordered_set<uint32_t> shortPrefixes_;  // (length << 24) | top bits
+    static constexpr uint32_t kTopMask = 0xFFFFFFu;
+    std::vector<Node> nodes_;
+    uint32_t freeList_;
+    size_t size_;
+
+    uint32_t& Reference(uint32_t slot, uint32_t parent, int dir) {
+        return parent == kNil ? roots_[slot] : nodes_[parent].child[dir];
+    }
+
+    uint32_t Allocate(const Key& key, int len, bool terminal) {
+        uint32_t idx;
+        if (freeList_ != kNil) {
+            idx = freeList_;
+            freeList_ = nodes_[idx].child[0];
+        } else {
+            idx = static_cast<uint32_t>(nodes_.size());
+            nodes_.emplace_back();
+        }
+        Node& node = nodes_[idx];
+        node.key = key;
+        node.child[0] = node.child[1] = kNil;
+        node.length = static_cast<uint8_t>(len);
+        node.terminal = terminal ? 1 : 0;
+        return idx;
+    }
+
+    void Release(uint32_t idx) {
+        nodes_[idx].terminal = 0;
+        nodes_[idx].child[0] = freeList_;
+        nodes_[idx].child[1] = kNil;
+        freeList_ = idx;
+    }
+
+    // Prefixes shorter than the first-level table are expanded into it
+    bool InsertShort(const Key& key, int len) {
+        const uint32_t top = Traits::Top(key);
+        if (!shortPrefixes_.insert((static_cast<uint32_t>(len) << 24) | top).second) {
+            return false;
+        }
+        const uint32_t span = 1u << (kRootBits - len);
+        for (uint32_t slot = top; slot < top + span; ++slot) {
+            if (shortBest_[slot] == kNoMatch || shortBest_[slot] < len) {
+                shortBest_[slot] = static_cast<uint8_t>(len);
+            }
+        }
+        ++size_;
+        return true;
+    }
+
+    bool RemoveShort(const Key& key, int len) {
+        const uint32_t top = Traits::Top(key);
+        if (shortPrefixes_.erase((static_cast<uint32_t>(len) << 24) | top) == 0) {
+            return false;
+        }
+        const uint32_t span = 1u << (kRootBits - len);
+        for (uint32_t slot = top; slot < top + span; ++slot) {
+            if (shortBest_[slot] != len) continue;
+            uint8_t best = kNoMatch;
+            for (int l = len - 1; l >= 0; --l) {
+                uint32_t covering = l == 0 ? 0 : (slot & ((kRootSlots - 1) << (kRootBits - l)) & (kRootSlots - 1));
+                if (shortPrefixes_.count((static_cast<uint32_t>(l) << 24) | covering)) {
+                    best = static_cast<uint8_t>(l);
+                    break;
+                }
+            }
+            shortBest_[slot] = best;
+        }
+        --size_;
+        return true;
+    }
+};
+
+namespace {
+
+inline uint32_t ToKey32(const IPAddress& address) {
+    return address.ToIPv4();
+}
+
+} // namespace
+
+std::string IPPrefixSet::Prefix::ToString() const {
+    std::string text = address.ToString();
+    if (length != (address.IsIPv4() ? 32 : 128)) {
+        text += '/';
+        text += std::to_string(length);
+    }
+    return text;
+}
+
+IPPrefixSet::IPPrefixSet()
+    : v4_(std::make_unique<Trie<uint32_t>>()), v6_(std::make_unique<Trie<Key128>>()) {
+}
+
+IPPrefixSet::~IPPrefixSet() = default;
+IPPrefixSet::IPPrefixSet(IPPrefixSet&&) noexcept = default;
+IPPrefixSet& IPPrefixSet::operator=(IPPrefixSet&&) noexcept = default;
+
+bool IPPrefixSet::ParseCidr(std::string_view text, IPAddress& address, int& length) {
+    size_t slash = text.find('/');
+    if (!IPAddress::Parse(text.substr(0, slash), address)) {
+        return false;
+    }
+
+    const int maxLength = address.IsIPv4() ? 32 : 128;
+    if (slash == std::string_view::npos) {
+        length = maxLength;
+        return true;
+    }
+
+    std::string_view digits = text.substr(slash + 1);
+    if (digits.empty() || digits.size() > 3) {
+        return false;
+    }
+    int value = 0;
+    for (char c : digits) {
+        if (c < '0' || c > '9') return false;
+        value = value * 10 + (c - '0');
+    }
+    if (value > maxLength) {
+        return false;
+    }
+    length = value;
+    return true;
+}
+
+bool IPPrefixSet::Insert(const IPAddress& address, int length) {
+    if (address.IsIPv4()) {
+        if (length < 0 || length > 32) return false;
+        return v4_->Insert(ToKey32(address), length);
+    }
+    if (length < 0 || length > 128) return false;
+    const uint8_t* b = address.Bytes();
+    return v6_->Insert(Key128{LoadBigEndian64(b), LoadBigEndian64(b + 8)}, length);
+}
+
+bool IPPrefixSet::Insert(std::string_view cidr) {
+    IPAddress address;
+    int length;
+    return ParseCidr(cidr, address, length) && Insert(address, length);
+}
+
+bool IPPrefixSet::Remove(const IPAddress& address, int length) {
+    if (address.IsIPv4()) {
+        if (length < 0 || length > 32) return false;
+        return v4_->Remove(ToKey32(address), length);
+    }
+    if (length < 0 || length > 128) return false;
+    const uint8_t* b = address.Bytes();
+    return v6_->Remove(Key128{LoadBigEndian64(b), LoadBigEndian64(b + 8)}, length);
+}
+
+bool IPPrefixSet::Remove(std::string_view cidr) {
+    IPAddress address;
+    int length;
+    return ParseCidr(cidr, address, length) && Remove(address, length);
+}
+
+void IPPrefixSet::Clear() {
+    v4_->Clear();
+    v6_->Clear();
+}
+
+int IPPrefixSet::LongestMatch(const IPAddress& address) const {
+    if (address.IsIPv4()) {
+        return v4_->LongestMatch(ToKey32(address));
+    }
+    const uint8_t* b = address.Bytes();
+    return v6_->LongestMatch(Key128{LoadBigEndian64(b), LoadBigEndian64(b + 8)});
+}
+
+size_t IPPrefixSet::Size() const {
+    return v4_->Size() + v6_->Size();
+}
+
+std::vector<IPPrefixSet::Prefix> IPPrefixSet::GetPrefixes() const {
+    std::vector<Prefix> result;
+    result.reserve(Size());
+    v4_->ForEach([&result](uint32_t key, int length) {
+        result.push_back(Prefix{IPAddress::FromIPv4(key), length});
+    });
+    v6_->ForEach([&result](const Key128& key, int length) {
+        uint8_t bytes[16];
+        StoreBigEndian64(bytes, key.hi);
+        StoreBigEndian64(bytes + 8, key.lo);
+        result.push_back(Prefix{IPAddress::FromIPv6Bytes(bytes), length});
+    });
+    return result;
+}
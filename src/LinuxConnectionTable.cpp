@@ -0,0 +1,186 @@
+#include "LinuxConnectionTable.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+inline int HexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+inline const char* SkipSpaces(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+    return p;
+}
+
+// Parses exactly `digits` hex characters; returns nullptr on malformed input
+inline const char* ParseHex32(const char* p, const char* end, int digits, uint32_t& value) {
+    if (end - p < digits) return nullptr;
+    uint32_t v = 0;
+    for (int i = 0; i < digits; ++i) {
+        int h = HexValue(p[i]);
+        if (h < 0) return nullptr;
+        v = (v << 4) | static_cast<uint32_t>(h);
+    }
+    value = v;
+    return p + digits;
+}
+
+// The kernel prints each 32-bit word of the address with %08X in host byte
+// order, so copying the parsed words back to memory yields network order.
+const char* ParseAddress(const char* p, const char* end, int words, uint8_t* bytes) {
+    for (int i = 0; i < words; ++i) {
+        uint32_t word;
+        p = ParseHex32(p, end, 8, word);
+        if (!p) return nullptr;
+        std::memcpy(bytes + i * 4, &word, 4);
+    }
+    return p;
+}
+
+} // namespace
+
+LinuxConnectionTable::LinuxConnectionTable(const std::string& procRoot)
+    : procRoot_(procRoot) {
+    for (int i = 0; i < 4; ++i) {
+        tablePaths_[i] = procRoot_ + GetTablePath(static_cast<Table>(i));
+    }
+}
+
+const char* LinuxConnectionTable::GetTablePath(Table table) {
+    switch (table) {
+        case Table::Tcp: return "/net/tcp";
+        case Table::Tcp6: return "/net/tcp6";
+        case Table::Udp: return "/net/udp";
+        case Table::Udp6: return "/net/udp6";
+    }
+    return "";
+}
+
+size_t LinuxConnectionTable::Read(Table table, std::vector<NetworkMonitor::NetworkConnection>& out,
+                                  size_t offset, uint32_t stateMask) {
+    size_t length = 0;
+    if (!LoadFile(tablePaths_[static_cast<int>(table)], length)) {
+        return 0;
+    }
+    return Parse(table, buffer_.data(), length, out, offset, std::chrono::system_clock::now(), stateMask);
+}
+
+size_t LinuxConnectionTable::Parse(Table table, const char* data, size_t length,
+                                   std::vector<NetworkMonitor::NetworkConnection>& out, size_t offset,
+                                   std::chrono::system_clock::time_point timestamp, uint32_t stateMask) {
+    const int words = IsIPv6(table) ? 4 : 1;
+
+    const char* p = data;
+    const char* end = data + length;
+
+    // Skip the column header line
+    const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    if (!nl) return 0;
+    p = nl + 1;
+
+    size_t written = 0;
+    uint8_t local[16], remote[16];
+
+    while (p < end) {
+        nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* lineEnd = nl ? nl : end;
+        const char* next = nl ? nl + 1 : end;
+
+        // "  sl: local:port remote:port st ..."
+        const char* q = SkipSpaces(p, lineEnd);
+        const char* colon = static_cast<const char*>(std::memchr(q, ':', lineEnd - q));
+        uint32_t localPort, remotePort, state;
+        if (!colon) { p = next; continue; }
+        q = SkipSpaces(colon + 1, lineEnd);
+        if (!(q = ParseAddress(q, lineEnd, words, local)) || q >= lineEnd || *q++ != ':' ||
+            !(q = ParseHex32(q, lineEnd, 4, localPort))) { p = next; continue; }
+        q = SkipSpaces(q, lineEnd);
+        if (!(q = ParseAddress(q, lineEnd, words, remote)) || q >= lineEnd || *q++ != ':' ||
+            !(q = ParseHex32(q, lineEnd, 4, remotePort))) { p = next; continue; }
+        q = SkipSpaces(q, lineEnd);
+        if (!(q = ParseHex32(q, lineEnd, 2, state))) { p = next; continue; }
+
+        if (!((stateMask >> (state & 31)) & 1u)) { p = next; continue; }
+
+        size_t index = offset + written;
+        if (index >= out.size()) {
+            out.emplace_back();
+        }
+        DecodeRow(out[index], table, local, static_cast<int>(localPort),
+                  remote, static_cast<int>(remotePort), state, timestamp);
+
+        ++written;
+        p = next;
+    }
+
+    return written;
+}
+
+void LinuxConnectionTable::DecodeRow(NetworkMonitor::NetworkConnection& conn, Table table,
+                                     const uint8_t* local, int localPort,
+                                     const uint8_t* remote, int remotePort, unsigned state,
+                                     std::chrono::system_clock::time_point timestamp) {
+    if (IsIPv6(table)) {
+        conn.localAddress = IPAddress::FromIPv6Bytes(local);
+        conn.remoteAddress = IPAddress::FromIPv6Bytes(remote);
+    } else {
+        conn.localAddress = IPAddress::FromIPv4Bytes(local);
+        conn.remoteAddress = IPAddress::FromIPv4Bytes(remote);
+    }
+    conn.localPort = static_cast<uint16_t>(localPort);
+    conn.remotePort = static_cast<uint16_t>(remotePort);
+    conn.protocol = IsTcp(table) ? NetworkMonitor::Protocol::TCP : NetworkMonitor::Protocol::UDP;
+    conn.state = static_cast<uint8_t>(state);
+    conn.processId = 0;
+    conn.processName.clear();
+    conn.timestamp = timestamp;
+}
+
+bool LinuxConnectionTable::LoadFile(const std::string& path, size_t& length) {
+#ifdef _WIN32
+    (void)path;
+    length = 0;
+    return false;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    // procfs hands out at most a page or so per read(), so loop until EOF and
+    // only grow the buffer when the table is larger than any seen before
+    constexpr size_t kMinFree = 64 * 1024;
+    length = 0;
+    for (;;) {
+        if (buffer_.size() - length < kMinFree) {
+            buffer_.resize(std::max(buffer_.size() * 2, length + kMinFree * 4));
+        }
+        ssize_t n = ::read(fd, buffer_.data() + length, buffer_.size() - length);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ::close(fd);
+            return false;
+        }
+        if (n == 0) {
+            break;
+        }
+        length += static_cast<size_t>(n);
+    }
+
+    ::close(fd);
+    return true;
+#endif
+}
@@ -0,0 +1,396 @@
+#include "LinuxProcessTable.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <thread>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+namespace {
+
+constexpr size_t kMinPidsPerThread = 1024;
+constexpr size_t kMaxThreads = 8;
+constexpr size_t kBufferSize = 8192;
+
+inline const char* SkipSpaces(const char* p, const char* end) {
+    while (p < end && *p == ' ') ++p;
+    return p;
+}
+
+// Optional leading '-' (ppid and tty fields may be negative); nullptr when no digits follow
+inline const char* ParseInteger(const char* p, const char* end, int64_t& value) {
+    p = SkipSpaces(p, end);
+    bool negative = false;
+    if (p < end && *p == '-') {
+        negative = true;
+        ++p;
+    }
+    if (p == end || *p < '0' || *p > '9') return nullptr;
+    int64_t v = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        v = v * 10 + (*p - '0');
+        ++p;
+    }
+    value = negative ? -v : v;
+    return p;
+}
+
+#ifndef _WIN32
+// Reads up to `limit` bytes of a file below `dirfd`; -1 when it cannot be
+// opened or read. stat and status are generated whole, so for them the first
+// read is the file (`oneRead`) and the read() that would return 0 is skipped.
+ssize_t ReadAt(int dirfd, const char* path, std::vector<char>& buffer, size_t limit, bool oneRead) {
+    int fd = ::openat(dirfd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    if (buffer.size() < limit) {
+        buffer.resize(limit);
+    }
+    size_t length = 0;
+    while (length < limit) {
+        ssize_t n = ::read(fd, buffer.data() + length, limit - length);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ::close(fd);
+            return -1;
+        }
+        length += static_cast<size_t>(n);
+        if (n == 0 || oneRead) {
+            break;
+        }
+    }
+    ::close(fd);
+    return static_cast<ssize_t>(length);
+}
+#endif
+
+} // namespace
+
+LinuxProcessTable::LinuxProcessTable(const std::string& procRoot, size_t threads)
+    : procRoot_(procRoot), procFd_(-1), threads_(threads), pageKb_(4), sampleCount_(0), generation_(0) {
+    if (threads_ == 0) {
+        threads_ = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), kMaxThreads);
+    }
+#ifndef _WIN32
+    const long pageSize = ::sysconf(_SC_PAGESIZE);
+    if (pageSize > 0) {
+        pageKb_ = pageSize / 1024;
+    }
+#endif
+}
+
+LinuxProcessTable::~LinuxProcessTable() {
+#ifndef _WIN32
+    if (procFd_ >= 0) {
+        ::close(procFd_);
+    }
+#endif
+}
+
+const char* LinuxProcessTable::GetChangeTypeName(Change::Type type) {
+    switch (type) {
+        case Change::Type::Spawned: return "spawned";
+        case Change::Type::Exited: return "exited";
+        case Change::Type::Changed: return "changed";
+    }
+    return "";
+}
+
+bool LinuxProcessTable::ParseStat(const char* data, size_t length, Process& process) {
+    // "pid (comm) state ppid ..."; comm may itself contain spaces and parentheses
+    const char* end = data + length;
+    const char* open = static_cast<const char*>(std::memchr(data, '(', length));
+    const char* close = end;
+    while (close > data && close[-1] != ')') --close;
+    if (!open || close <= open + 1) {
+        return false;
+    }
+    int64_t pid;
+    if (!ParseInteger(data, open, pid)) {
+        return false;
+    }
+    process.pid = static_cast<int>(pid);
+    process.name.assign(open + 1, close - 1);
+
+    const char* p = SkipSpaces(close, end);
+    if (p == end) {
+        return false;
+    }
+    process.state = *p++;
+
+    // Fields 4 (ppid) through 24 (rss), numbered as in proc(5)
+    int64_t fields[25];
+    for (int field = 4; field <= 24; ++field) {
+        p = ParseInteger(p, end, fields[field]);
+        if (!p) {
+            return false;
+        }
+    }
+    process.ppid = static_cast<int>(fields[4]);
+    process.cpuTicks = static_cast<uint64_t>(fields[14] + fields[15]);
+    process.startTime = static_cast<uint64_t>(fields[22]);
+    process.rssKb = static_cast<uint64_t>(std::max<int64_t>(fields[24], 0));  // pages until scaled
+    return true;
+}
+
+bool LinuxProcessTable::ListPids() {
+#ifdef _WIN32
+    return false;
+#else
+    if (procFd_ < 0) {
+        procFd_ = ::open(procRoot_.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (procFd_ < 0) {
+            return false;
+        }
+    }
+    // A fresh descriptor per listing: the directory stream owns and closes it
+    int fd = ::openat(procFd_, ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    DIR* dir = fd < 0 ? nullptr : ::fdopendir(fd);
+    if (!dir) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return false;
+    }
+
+    sampleCount_ = 0;
+    while (const dirent* entry = ::readdir(dir)) {
+        const char* name = entry->d_name;
+        if (name[0] < '1' || name[0] > '9') {
+            continue;
+        }
+        int pid = 0;
+        for (; *name >= '0' && *name <= '9'; ++name) {
+            pid = pid * 10 + (*name - '0');
+        }
+        if (*name != '\0') {
+            continue;
+        }
+        if (sampleCount_ == samples_.size()) {
+            samples_.emplace_back();
+        }
+        samples_[sampleCount_++].pid = pid;
+    }
+    ::closedir(dir);
+    return true;
+#endif
+}
+
+bool LinuxProcessTable::ReadSample(Sample& sample, std::vector<char>& buffer) const {
+#ifdef _WIN32
+    (void)sample;
+    (void)buffer;
+    return false;
+#else
+    Process& process = sample.process;
+    char path[32];
+    std::snprintf(path, sizeof(path), "%d", sample.pid);
+    struct stat info;
+    if (::fstatat(procFd_, path, &info, 0) != 0) {
+        return false;
+    }
+    sample.inode = static_cast<uint64_t>(info.st_ino);
+    sample.owner = static_cast<uint32_t>(info.st_uid);
+    sample.full = false;
+
+    auto it = table_.find(sample.pid);
+    const bool same = it != table_.end() && it->second.inode == sample.inode && it->second.owner == sample.owner;
+    sample.statRead = !same || NeedsStat(it->second);
+    if (!sample.statRead) {
+        return true;
+    }
+
+    std::snprintf(path, sizeof(path), "%d/stat", sample.pid);
+    ssize_t length = ReadAt(procFd_, path, buffer, kBufferSize, true);
+    if (length <= 0 || !ParseStat(buffer.data(), static_cast<size_t>(length), process)) {
+        return false;
+    }
+    process.rssKb *= static_cast<uint64_t>(pageKb_);
+
+    // Same process, same command name and owner: the rest has not changed
+    sample.full = it == table_.end() || it->second.process.startTime != process.startTime ||
+                  it->second.process.name != process.name || it->second.owner != sample.owner;
+    if (!sample.full) {
+        return true;
+    }
+
+    process.uid = 0;
+    std::snprintf(path, sizeof(path), "%d/status", sample.pid);
+    length = ReadAt(procFd_, path, buffer, kBufferSize, true);
+    if (length > 0) {
+        const char* end = buffer.data() + length;
+        for (const char* p = buffer.data(); p < end;) {
+            const char* line = p;
+            const void* newline = std::memchr(p, '\n', static_cast<size_t>(end - p));
+            p = newline ? static_cast<const char*>(newline) + 1 : end;
+            if (end - line > 4 && std::memcmp(line, "Uid:", 4) == 0) {
+                int64_t uid;
+                const char* q = line + 4;
+                while (q < end && *q == '\t') ++q;
+                if (ParseInteger(q, end, uid)) {
+                    process.uid = static_cast<uint32_t>(uid);
+                }
+                break;
+            }
+        }
+    }
+
+    process.cmdline.clear();
+    std::snprintf(path, sizeof(path), "%d/cmdline", sample.pid);
+    length = ReadAt(procFd_, path, buffer, kMaxCmdline, false);
+    if (length > 0) {
+        process.cmdline.assign(buffer.data(), static_cast<size_t>(length));
+        while (!process.cmdline.empty() && process.cmdline.back() == '\0') {
+            process.cmdline.pop_back();
+        }
+        std::replace(process.cmdline.begin(), process.cmdline.end(), '\0', ' ');
+    }
+
+    process.exe.clear();
+    std::snprintf(path, sizeof(path), "%d/exe", sample.pid);
+    char target[4096];
+    const ssize_t targetLength = ::readlinkat(procFd_, path, target, sizeof(target));
+    if (targetLength > 0) {
+        process.exe.assign(target, static_cast<size_t>(targetLength));
+    }
+    return true;
+#endif
+}
+
+bool LinuxProcessTable::NeedsStat(const Entry& entry) const {
+    // generation_ is still the previous scan's here; the pid staggers the
+    // periodic refresh so each scan takes its share
+    return generation_ - entry.born < kYoungScans ||
+           (static_cast<uint64_t>(entry.process.pid) + generation_) % kRefreshScans == 0 ||
+           std::binary_search(exitedPids_.begin(), exitedPids_.end(), entry.process.ppid);
+}
+
+void LinuxProcessTable::ReadRange(size_t begin, size_t end) {
+    std::vector<char> buffer(kBufferSize);
+    for (size_t i = begin; i < end; ++i) {
+        samples_[i].alive = ReadSample(samples_[i], buffer);
+    }
+}
+
+bool LinuxProcessTable::Scan(std::vector<Change>& changes) {
+    if (!ListPids()) {
+        return false;
+    }
+
+    // Workers only read table_; it changes in Merge once they are done
+    const size_t threads = std::min(threads_, std::max<size_t>(1, sampleCount_ / kMinPidsPerThread));
+    if (threads <= 1) {
+        ReadRange(0, sampleCount_);
+    } else {
+        std::vector<std::thread> workers;
+        const size_t chunk = (sampleCount_ + threads - 1) / threads;
+        for (size_t t = 1; t < threads; ++t) {
+            workers.emplace_back(&LinuxProcessTable::ReadRange, this,
+                                 std::min(t * chunk, sampleCount_), std::min((t + 1) * chunk, sampleCount_));
+        }
+        ReadRange(0, std::min(chunk, sampleCount_));
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    Merge(changes);
+    return true;
+}
+
+void LinuxProcessTable::Merge(std::vector<Change>& changes) {
+    generation_++;
+    exitedPids_.clear();
+    for (size_t i = 0; i < sampleCount_; ++i) {
+        const Sample& sample = samples_[i];
+        if (!sample.alive) {
+            continue;  // gone since the listing; reported below if it was known
+        }
+        auto it = table_.find(sample.pid);
+        if (!sample.statRead) {
+            it->second.seen = generation_;
+            continue;
+        }
+        const Process& current = sample.process;
+
+        if (it != table_.end() && it->second.process.startTime != current.startTime) {
+            // Recycled pid
+            exitedPids_.push_back(sample.pid);
+            changes.push_back(Change{Change::Type::Exited, 0, std::move(it->second.process)});
+            table_.erase(it);
+            it = table_.end();
+        }
+        if (it == table_.end()) {
+            table_.emplace(sample.pid, Entry{current, generation_, generation_, sample.inode, sample.owner});
+            changes.push_back(Change{Change::Type::Spawned, 0, current});
+            continue;
+        }
+
+        Entry& entry = it->second;
+        Process& known = entry.process;
+        entry.seen = generation_;
+        entry.inode = sample.inode;
+        entry.owner = sample.owner;
+        uint32_t fields = 0;
+        if (known.ppid != current.ppid) {
+            fields |= kParentChanged;
+        }
+        known.ppid = current.ppid;
+        known.state = current.state;
+        known.cpuTicks = current.cpuTicks;
+        known.rssKb = current.rssKb;
+        if (sample.full) {
+            if (known.name != current.name) fields |= kNameChanged;
+            if (known.exe != current.exe) fields |= kExeChanged;
+            if (known.cmdline != current.cmdline) fields |= kCmdlineChanged;
+            if (known.uid != current.uid) fields |= kUserChanged;
+            known.name = current.name;
+            known.exe = current.exe;
+            known.cmdline = current.cmdline;
+            known.uid = current.uid;
+        }
+        if (fields) {
+            changes.push_back(Change{Change::Type::Changed, fields, known});
+        }
+    }
+
+    for (auto it = table_.begin(); it != table_.end();) {
+        if (it->second.seen != generation_) {
+            exitedPids_.push_back(it->first);
+            changes.push_back(Change{Change::Type::Exited, 0, std::move(it->second.process)});
+            it = table_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    std::sort(exitedPids_.begin(), exitedPids_.end());
+}
+
+std::vector<LinuxProcessTable::Process> LinuxProcessTable::GetProcesses() const {
+    std::vector<Process> processes;
+    processes.reserve(table_.size());
+    for (const auto& entry : table_) {
+        processes.push_back(entry.second.process);
+    }
+    std::sort(processes.begin(), processes.end(),
+              [](const Process& a, const Process& b) { return a.pid < b.pid; });
+    return processes;
+}
+
+bool LinuxProcessTable::GetProcess(int pid, Process& process) const {
+    auto it = table_.find(pid);
+    if (it == table_.end()) {
+        return false;
+    }
+    process = it->second.process;
+    return true;
+}
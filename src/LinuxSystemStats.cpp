@@ -0,0 +1,313 @@
+#include "LinuxSystemStats.h"
+#include <algorithm>
+#include <cstring>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr size_t kInitialBufferSize = 16 * 1024;
+
+inline const char* SkipSpaces(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+    return p;
+}
+
+inline const char* NextLine(const char* p, const char* end) {
+    const void* newline = std::memchr(p, '\n', static_cast<size_t>(end - p));
+    return newline ? static_cast<const char*>(newline) + 1 : end;
+}
+
+// Returns nullptr when no digits follow
+inline const char* ParseUnsigned(const char* p, const char* end, uint64_t& value) {
+    p = SkipSpaces(p, end);
+    if (p == end || *p < '0' || *p > '9') return nullptr;
+    uint64_t v = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        v = v * 10 + static_cast<uint64_t>(*p - '0');
+        ++p;
+    }
+    value = v;
+    return p;
+}
+
+// "12.34"; loadavg always prints two decimals, but any count is accepted
+inline const char* ParseDecimal(const char* p, const char* end, double& value) {
+    uint64_t whole;
+    p = ParseUnsigned(p, end, whole);
+    if (!p) return nullptr;
+    double v = static_cast<double>(whole);
+    if (p < end && *p == '.') {
+        double scale = 0.1;
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p, scale /= 10) {
+            v += (*p - '0') * scale;
+        }
+    }
+    value = v;
+    return p;
+}
+
+inline uint64_t Jiffies(const LinuxSystemStats::CpuTimes& times) {
+    return times.user + times.nice + times.system + times.idle + times.iowait + times.irq + times.softirq + times.steal;
+}
+
+inline uint64_t Elapsed(uint64_t previous, uint64_t current) {
+    // Counters restart when a CPU goes offline and comes back
+    return current > previous ? current - previous : 0;
+}
+
+} // namespace
+
+double LinuxSystemStats::MemoryInfo::UsedPercent() const {
+    if (totalKb == 0) {
+        return 0.0;
+    }
+    const uint64_t available = std::min(availableKb, totalKb);
+    return 100.0 * static_cast<double>(totalKb - available) / static_cast<double>(totalKb);
+}
+
+LinuxSystemStats::LinuxSystemStats(const std::string& procRoot)
+    : buffer_(kInitialBufferSize), previousTotal_(), cpuReads_(0), totalUsage_(), memory_(), load_() {
+    paths_[kStat] = procRoot + "/stat";
+    paths_[kMeminfo] = procRoot + "/meminfo";
+    paths_[kLoadavg] = procRoot + "/loadavg";
+    for (int& fd : fds_) {
+        fd = -1;
+    }
+}
+
+LinuxSystemStats::~LinuxSystemStats() {
+#ifndef _WIN32
+    for (int fd : fds_) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+#endif
+}
+
+bool LinuxSystemStats::ReadFile(File file, size_t& length) {
+#ifdef _WIN32
+    (void)file;
+    length = 0;
+    return false;
+#else
+    int& fd = fds_[file];
+    if (fd < 0) {
+        fd = ::open(paths_[file].c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+    }
+
+    // procfs regenerates the file on a read from offset 0. The buffer only
+    // grows when the file no longer fits, which settles after the first read.
+    length = 0;
+    for (;;) {
+        if (length == buffer_.size()) {
+            buffer_.resize(buffer_.size() * 2);
+        }
+        ssize_t n = ::pread(fd, buffer_.data() + length, buffer_.size() - length, static_cast<off_t>(length));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // Reopen on the next sample
+            ::close(fd);
+            fd = -1;
+            return false;
+        }
+        if (n == 0) {
+            return true;
+        }
+        length += static_cast<size_t>(n);
+    }
+#endif
+}
+
+bool LinuxSystemStats::ReadCpu() {
+    size_t length;
+    CpuTimes total;
+    if (!ReadFile(kStat, length) || !ParseStat(buffer_.data(), length, total, currentCpus_)) {
+        return false;
+    }
+
+    if (cpuReads_ > 0) {
+        if (Jiffies(total) <= Jiffies(previousTotal_)) {
+            return true;  // less than a tick since the last sample: keep its figures
+        }
+        totalUsage_ = Delta(previousTotal_, total);
+    }
+    if (cpuUsage_.size() != currentCpus_.size()) {
+        cpuUsage_.assign(currentCpus_.size(), CpuUsage());
+    }
+    // Per-CPU deltas need the same CPUs on both sides; after a hotplug
+    // change they restart from the next sample
+    if (previousCpus_.size() == currentCpus_.size()) {
+        for (size_t i = 0; i < currentCpus_.size(); ++i) {
+            cpuUsage_[i] = Delta(previousCpus_[i], currentCpus_[i]);
+        }
+    }
+
+    previousTotal_ = total;
+    previousCpus_.swap(currentCpus_);
+    cpuReads_++;
+    return true;
+}
+
+bool LinuxSystemStats::ReadMemory() {
+    size_t length;
+    MemoryInfo memory;
+    if (!ReadFile(kMeminfo, length) || !ParseMeminfo(buffer_.data(), length, memory)) {
+        return false;
+    }
+    memory_ = memory;
+    return true;
+}
+
+bool LinuxSystemStats::ReadLoad() {
+    size_t length;
+    LoadAverage load;
+    if (!ReadFile(kLoadavg, length) || !ParseLoadavg(buffer_.data(), length, load)) {
+        return false;
+    }
+    load_ = load;
+    return true;
+}
+
+bool LinuxSystemStats::Sample() {
+    const bool cpu = ReadCpu();
+    const bool memory = ReadMemory();
+    const bool load = ReadLoad();
+    return cpu && memory && load;
+}
+
+bool LinuxSystemStats::ParseStat(const char* data, size_t length, CpuTimes& total, std::vector<CpuTimes>& cpus) {
+    const char* p = data;
+    const char* end = data + length;
+    bool haveTotal = false;
+    size_t count = 0;
+
+    // The "cpu" lines come first; stop at the first other line
+    while (p < end && end - p > 3 && std::memcmp(p, "cpu", 3) == 0) {
+        const char* line = p + 3;
+        const bool aggregate = line < end && (*line == ' ' || *line == '\t');
+        while (line < end && *line >= '0' && *line <= '9') ++line;
+
+        // Older kernels print fewer columns; missing ones stay zero
+        uint64_t fields[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+        size_t parsed = 0;
+        for (const char* q = line; parsed < 8; ++parsed) {
+            q = ParseUnsigned(q, end, fields[parsed]);
+            if (!q) break;
+            line = q;
+        }
+        if (parsed < 4) {
+            return false;
+        }
+
+        CpuTimes times{fields[0], fields[1], fields[2], fields[3], fields[4], fields[5], fields[6], fields[7]};
+        if (aggregate) {
+            total = times;
+            haveTotal = true;
+        } else {
+            if (count == cpus.size()) {
+                cpus.push_back(times);  // only when CPUs were added
+            } else {
+                cpus[count] = times;
+            }
+            count++;
+        }
+        p = NextLine(line, end);
+    }
+
+    cpus.resize(count);
+    return haveTotal;
+}
+
+bool LinuxSystemStats::ParseMeminfo(const char* data, size_t length, MemoryInfo& memory) {
+    struct Field {
+        const char* name;
+        size_t nameLength;
+        uint64_t MemoryInfo::*value;
+    };
+    static const Field kFields[] = {
+        {"MemTotal", 8, &MemoryInfo::totalKb},
+        {"MemFree", 7, &MemoryInfo::freeKb},
+        {"MemAvailable", 12, &MemoryInfo::availableKb},
+        {"Buffers", 7, &MemoryInfo::buffersKb},
+        {"Cached", 6, &MemoryInfo::cachedKb},
+        {"SwapTotal", 9, &MemoryInfo::swapTotalKb},
+        {"SwapFree", 8, &MemoryInfo::swapFreeKb},
+    };
+
+    memory = MemoryInfo();
+    bool haveTotal = false;
+    bool haveAvailable = false;
+    const char* end = data + length;
+    for (const char* p = data; p < end; p = NextLine(p, end)) {
+        const void* colon = std::memchr(p, ':', static_cast<size_t>(end - p));
+        if (!colon) {
+            break;
+        }
+        const size_t nameLength = static_cast<size_t>(static_cast<const char*>(colon) - p);
+        for (const Field& field : kFields) {
+            if (nameLength == field.nameLength && std::memcmp(p, field.name, nameLength) == 0) {
+                uint64_t value;
+                if (ParseUnsigned(static_cast<const char*>(colon) + 1, end, value)) {
+                    memory.*field.value = value;
+                    haveTotal |= field.value == &MemoryInfo::totalKb;
+                    haveAvailable |= field.value == &MemoryInfo::availableKb;
+                }
+                break;
+            }
+        }
+    }
+
+    if (!haveAvailable) {
+        memory.availableKb = memory.freeKb + memory.buffersKb + memory.cachedKb;
+    }
+    return haveTotal && memory.totalKb != 0;
+}
+
+bool LinuxSystemStats::ParseLoadavg(const char* data, size_t length, LoadAverage& load) {
+    // "0.52 0.58 0.59 2/1234 5678"
+    const char* p = data;
+    const char* end = data + length;
+    uint64_t runnable;
+    uint64_t total;
+    if (!(p = ParseDecimal(p, end, load.one)) || !(p = ParseDecimal(p, end, load.five)) ||
+        !(p = ParseDecimal(p, end, load.fifteen)) || !(p = ParseUnsigned(p, end, runnable)) ||
+        p == end || *p != '/' || !(p = ParseUnsigned(p + 1, end, total))) {
+        return false;
+    }
+    load.runnable = static_cast<uint32_t>(runnable);
+    load.total = static_cast<uint32_t>(total);
+    return true;
+}
+
+LinuxSystemStats::CpuUsage LinuxSystemStats::Delta(const CpuTimes& previous, const CpuTimes& current) {
+    const uint64_t user = Elapsed(previous.user, current.user) + Elapsed(previous.nice, current.nice);
+    const uint64_t system = Elapsed(previous.system, current.system) + Elapsed(previous.irq, current.irq) +
+                            Elapsed(previous.softirq, current.softirq);
+    const uint64_t idle = Elapsed(previous.idle, current.idle);
+    const uint64_t iowait = Elapsed(previous.iowait, current.iowait);
+    const uint64_t steal = Elapsed(previous.steal, current.steal);
+    const uint64_t total = user + system + idle + iowait + steal;
+
+    CpuUsage usage{0.0, 0.0, 0.0, 0.0, 0.0};
+    if (total == 0) {
+        return usage;
+    }
+    const double scale = 100.0 / static_cast<double>(total);
+    usage.user = user * scale;
+    usage.system = system * scale;
+    usage.iowait = iowait * scale;
+    usage.steal = steal * scale;
+    usage.busy = (user + system + steal) * scale;
+    return usage;
+}
@@ -0,0 +1,151 @@
+#include "NetlinkSockDiag.h"
+#include <cstring>
+
+#ifdef __linux__
+#include <cerrno>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <linux/netlink.h>
+#include <linux/sock_diag.h>
+#include <linux/inet_diag.h>
+#endif
+
+namespace {
+
+// One receive covers several hundred records; the kernel fills it per dump batch
+constexpr size_t kReceiveBufferSize = 256 * 1024;
+
+} // namespace
+
+NetlinkSockDiag::NetlinkSockDiag() : socket_(-1), sequence_(0) {
+}
+
+NetlinkSockDiag::~NetlinkSockDiag() {
+    Close();
+}
+
+bool NetlinkSockDiag::Open() {
+#ifdef __linux__
+    if (socket_ >= 0) {
+        return true;
+    }
+
+    socket_ = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_SOCK_DIAG);
+    if (socket_ < 0) {
+        return false;
+    }
+
+    int rcvbuf = 4 * 1024 * 1024;
+    ::setsockopt(socket_, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    buffer_.resize(kReceiveBufferSize);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void NetlinkSockDiag::Close() {
+#ifdef __linux__
+    if (socket_ >= 0) {
+        ::close(socket_);
+        socket_ = -1;
+    }
+#endif
+}
+
+bool NetlinkSockDiag::Dump(LinuxConnectionTable::Table table, uint32_t stateMask,
+                           std::vector<NetworkMonitor::NetworkConnection>& out, size_t offset,
+                           size_t& written) {
+    written = 0;
+#ifdef __linux__
+    if (socket_ < 0) {
+        return false;
+    }
+
+    const bool isV6 = LinuxConnectionTable::IsIPv6(table);
+
+    struct {
+        nlmsghdr header;
+        inet_diag_req_v2 request;
+    } message;
+    std::memset(&message, 0, sizeof(message));
+    message.header.nlmsg_len = sizeof(message);
+    message.header.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+    message.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    message.header.nlmsg_seq = ++sequence_;
+    message.request.sdiag_family = isV6 ? AF_INET6 : AF_INET;
+    message.request.sdiag_protocol = LinuxConnectionTable::IsTcp(table) ? IPPROTO_TCP : IPPROTO_UDP;
+    message.request.idiag_states = stateMask;
+
+    sockaddr_nl kernel;
+    std::memset(&kernel, 0, sizeof(kernel));
+    kernel.nl_family = AF_NETLINK;
+
+    ssize_t sent;
+    do {
+        sent = ::sendto(socket_, &message, sizeof(message), 0,
+                        reinterpret_cast<sockaddr*>(&kernel), sizeof(kernel));
+    } while (sent < 0 && errno == EINTR);
+    if (sent < 0) {
+        return false;
+    }
+
+    const auto timestamp = std::chrono::system_clock::now();
+    const uint32_t expectedSequence = sequence_;
+    uint8_t local[16], remote[16];
+
+    for (;;) {
+        ssize_t received = ::recv(socket_, buffer_.data(), buffer_.size(), 0);
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        int remaining = static_cast<int>(received);
+        for (auto* header = reinterpret_cast<nlmsghdr*>(buffer_.data());
+             NLMSG_OK(header, remaining);
+             header = NLMSG_NEXT(header, remaining)) {
+            if (header->nlmsg_seq != expectedSequence) {
+                continue; // stale reply from an aborted earlier dump
+            }
+            if (header->nlmsg_type == NLMSG_DONE) {
+                return true;
+            }
+            if (header->nlmsg_type == NLMSG_ERROR) {
+                return false;
+            }
+            if (header->nlmsg_type != SOCK_DIAG_BY_FAMILY) {
+                continue;
+            }
+
+            const auto* diag = static_cast<const inet_diag_msg*>(NLMSG_DATA(header));
+            if (isV6) {
+                std::memcpy(local, diag->id.idiag_src, 16);
+                std::memcpy(remote, diag->id.idiag_dst, 16);
+            } else {
+                std::memcpy(local, diag->id.idiag_src, 4);
+                std::memcpy(remote, diag->id.idiag_dst, 4);
+            }
+
+            size_t index = offset + written;
+            if (index >= out.size()) {
+                out.emplace_back();
+            }
+            LinuxConnectionTable::DecodeRow(out[index], table,
+                                            local, ntohs(diag->id.idiag_sport),
+                                            remote, ntohs(diag->id.idiag_dport),
+                                            diag->idiag_state, timestamp);
+            ++written;
+        }
+    }
+#else
+    (void)table;
+    (void)stateMask;
+    (void)out;
+    (void)offset;
+    return false;
+#endif
+}
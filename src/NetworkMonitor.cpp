@@ -1,11 +1,76 @@
 #include "NetworkMonitor.h"
+#include "LinuxConnectionTable.h"
+#include "NetlinkSockDiag.h"
+#include "ThreatIntelDB.h"
+#include "SignatureEngine.h"
 #include "Utils.h"
 #include <thread>
 #include <mutex>
 #include <random>
 #include <algorithm>
 
-NetworkMonitor::NetworkMonitor() : isMonitoring_(false), nextLogId_(1) {
+namespace {
+
+// Distinct (host, port) targets a single source may touch before it is a scan
+constexpr double kPortScanFanoutThreshold = 20.0;
+
+// Thresholds are new connections per RateSketch window (60s by default)
+constexpr double kModerateActivityThreshold = 50.0;
+constexpr double kDDoSThreshold = 100.0;
+
+// Kernel TCP states relevant to half-open tracking
+constexpr uint8_t kTcpEstablished = 1;
+constexpr uint8_t kTcpSynRecv = 3;
+constexpr uint8_t kTcpClose = 7;
+constexpr uint8_t kTcpNewSynRecv = 12;
+
+// Packet flows are checked for half-open handshakes at the live scan cadence
+constexpr auto kPacketScanInterval = std::chrono::seconds(5);
+
+// Feed files are re-checked (stat only) this often; a rebuild runs only when one changed
+constexpr auto kThreatIntelCheckInterval = std::chrono::seconds(60);
+
+// Keys a scanned socket initiator-first, matching how packet sources key flows
+FlowTable::Key FlowKeyOf(const NetworkMonitor::NetworkConnection& conn, bool inbound) {
+    const uint8_t protocol = conn.protocol == NetworkMonitor::Protocol::TCP
+        ? PacketDecoder::kProtocolTcp : PacketDecoder::kProtocolUdp;
+    return inbound
+        ? FlowTable::Key::Make(conn.remoteAddress, conn.remotePort, conn.localAddress, conn.localPort, protocol)
+        : FlowTable::Key::Make(conn.localAddress, conn.localPort, conn.remoteAddress, conn.remotePort, protocol);
+}
+uint32_t ListenerKey(NetworkMonitor::Protocol protocol, uint16_t port) {
+    return (static_cast<uint32_t>(protocol) << 16) | port;
+}
+
+} // namespace
+
+const char* NetworkMonitor::NetworkConnection::GetProtocolName() const {
+    return protocol == Protocol::TCP ? "TCP" : "UDP";
+}
+
+const char* NetworkMonitor::NetworkConnection::GetStateName() const {
+    // Kernel socket states (include/net/tcp_states.h)
+    static const char* const kTcpStates[] = {
+        "UNKNOWN", "ESTABLISHED", "SYN_SENT", "SYN_RECV", "FIN_WAIT1", "FIN_WAIT2",
+        "TIME_WAIT", "CLOSE", "CLOSE_WAIT", "LAST_ACK", "LISTEN", "CLOSING", "NEW_SYN_RECV"
+    };
+
+    if (protocol == Protocol::UDP) {
+        return state == 1 ? "ESTABLISHED" : "UNCONN";
+    }
+    return state < sizeof(kTcpStates) / sizeof(kTcpStates[0]) ? kTcpStates[state] : "UNKNOWN";
+}
+
+NetworkMonitor::NetworkMonitor(size_t logCapacity)
+    : isMonitoring_(false), nextLogId_(1), scanCount_(0),
+      connectionTable_(std::make_unique<LinuxConnectionTable>()),
+      sockDiag_(std::make_unique<NetlinkSockDiag>()),
+      scanBackend_(ScanBackend::Auto), stateFilter_(StateAll),
+      netlinkUnavailable_(false), lastScanBackend_(ScanBackend::ProcFs),
+      procTiming_(), netlinkTiming_(), logs_(logCapacity),
+      packetTotals_(), packetSecond_(), packetScanTime_(), threatIntelFailed_(0),
+      signatureGeneration_(0),
+      packetClockSet_(false), packetClockOffset_() {
 }
 
 NetworkMonitor::~NetworkMonitor() {
@@ -42,94 +107,483 @@ std::vector<NetworkMonitor::NetworkConnection> NetworkMonitor::GetActiveConnecti
     return connections_;
 }
 
+void NetworkMonitor::SetThreatCallback(ThreatCallback callback) {
+    threatCallback_ = callback;
+}
+
 std::vector<NetworkMonitor::NetworkLog> NetworkMonitor::GetNetworkLogs(int limit) const {
-    std::lock_guard<std::mutex> lock(logsMutex_);
-    
-    std::vector<NetworkLog> result;
-    int count = std::min(limit, static_cast<int>(logs_.size()));
-    
-    if (count > 0) {
-        result.assign(logs_.end() - count, logs_.end());
+    if (limit <= 0) {
+        return {};
     }
-    
-    return result;
+    return logs_.Snapshot(static_cast<size_t>(limit));
+}
+
+void NetworkMonitor::SetScanBackend(ScanBackend backend) {
+    scanBackend_.store(backend);
+    netlinkUnavailable_.store(false); // allow an explicit request to retry netlink
+}
+
+NetworkMonitor::ScanBackend NetworkMonitor::GetScanBackend() const {
+    return scanBackend_.load();
+}
+
+void NetworkMonitor::SetConnectionStateFilter(uint32_t stateMask) {
+    stateFilter_.store(stateMask);
+}
+
+NetworkMonitor::ScanTiming NetworkMonitor::GetScanTiming(ScanBackend backend) const {
+    std::lock_guard<std::mutex> lock(connectionsMutex_);
+    return backend == ScanBackend::Netlink ? netlinkTiming_ : procTiming_;
 }
 
 NetworkMonitor::TrafficStats NetworkMonitor::GetCurrentStats() const {
     TrafficStats stats;
-    stats.bytesReceived = 1024000;
-    stats.bytesSent = 512000;
-    stats.packetsReceived = 1500;
-    stats.packetsSent = 800;
-    stats.connectionsActive = 25;
-    stats.connectionsTotal = 150;
+    {
+        std::lock_guard<std::mutex> lock(flowMutex_);
+        stats = packetTotals_;
+        stats.connectionsActive = static_cast<uint32_t>(flows_.Size());
+        stats.connectionsTotal = static_cast<uint32_t>(flows_.GetTotalCreated());
+    }
+
+    // Without a packet source there are no byte counts yet; keep the placeholders
+    if (stats.packetsReceived == 0) {
+        stats.bytesReceived = 1024000;
+        stats.bytesSent = 512000;
+        stats.packetsReceived = 1500;
+        stats.packetsSent = 800;
+    }
     stats.timestamp = std::chrono::system_clock::now();
     return stats;
 }
 
-std::vector<NetworkMonitor::TrafficStats> NetworkMonitor::GetStatsHistory(int minutes) const {
+size_t NetworkMonitor::GetConnectionCount() const {
+    std::lock_guard<std::mutex> lock(connectionsMutex_);
+    return connections_.size();
+}
+
+size_t NetworkMonitor::GetFlowCount() const {
+    std::lock_guard<std::mutex> lock(flowMutex_);
+    return flows_.Size();
+}
+
+void NetworkMonitor::ProcessPacket(const PacketDecoder::Packet& packet, uint32_t wireLength,
+                                   std::chrono::system_clock::time_point timestamp) {
+    const bool isTcp = packet.ipProtocol == PacketDecoder::kProtocolTcp;
+    const bool isUdp = packet.ipProtocol == PacketDecoder::kProtocolUdp;
+
+    NetworkConnection conn;
+    conn.localAddress = packet.destinationIp;
+    conn.remoteAddress = packet.sourceIp;
+    conn.timestamp = timestamp;
+    conn.processId = 0;
+    conn.localPort = packet.destinationPort;
+    conn.remotePort = packet.sourcePort;
+    conn.protocol = isTcp ? Protocol::TCP : Protocol::UDP;
+    conn.state = isTcp ? 3 : 1; // SYN_RECV / connected datagram
+
+    bool newFlow = false;
+    RateSketch::Clock::time_point detectorTime;
+    std::shared_ptr<const SignatureEngine> signatures;
+    std::vector<uint32_t> signatureHits;
+    {
+        std::lock_guard<std::mutex> lock(flowMutex_);
+        const auto second = std::chrono::time_point_cast<std::chrono::seconds>(timestamp);
+        if (second != packetSecond_.timestamp) {
+            RecordPacketSecond();
+            packetSecond_ = TrafficStats();
+            packetSecond_.timestamp = second;
+            flows_.Expire(timestamp);
+        }
+        if (!packetClockSet_) {
+            packetClockOffset_ = RateSketch::Clock::now().time_since_epoch() - timestamp.time_since_epoch();
+            packetClockSet_ = true;
+        }
+        detectorTime = RateSketch::Clock::time_point(timestamp.time_since_epoch() + packetClockOffset_);
+
+        packetSecond_.bytesReceived += wireLength;
+        packetSecond_.packetsReceived++;
+        packetTotals_.bytesReceived += wireLength;
+        packetTotals_.packetsReceived++;
+        packetTotals_.timestamp = timestamp;
+
+        if (packet.hasTransport && (isTcp || isUdp)) {
+            bool created;
+            FlowTable::Key key = FlowTable::Key::Make(packet.sourceIp, packet.sourcePort,
+                                                      packet.destinationIp, packet.destinationPort,
+                                                      packet.ipProtocol);
+            bool reverse = false;
+            FlowTable::Flow* flow = flows_.Update(key, wireLength, packet.tcpFlags, timestamp, created, &reverse);
+
+            // Detectors see connection attempts: a bare SYN, or the first datagram of a UDP flow
+            const bool bareSyn = (packet.tcpFlags & (PacketDecoder::TcpSyn | PacketDecoder::TcpAck)) == PacketDecoder::TcpSyn;
+            newFlow = created && (isUdp || bareSyn);
+
+            // Minimal handshake tracking: half-open until the initiator ACKs
+            if (flow && isTcp) {
+                if (created) {
+                    flow->state = bareSyn ? kTcpSynRecv : kTcpEstablished;
+                } else if (packet.tcpFlags & (PacketDecoder::TcpFin | PacketDecoder::TcpRst)) {
+                    flow->state = kTcpClose;
+                } else if (!reverse && flow->state == kTcpSynRecv && !(packet.tcpFlags & PacketDecoder::TcpSyn) &&
+                           (packet.tcpFlags & PacketDecoder::TcpAck)) {
+                    flow->state = kTcpEstablished;
+                }
+            }
+
+            // Signatures continue across the packets of each direction
+            if (flow && signatures_ && packet.payloadLength) {
+                if (flow->payloadTag != signatureGeneration_) {
+                    flow->payloadTag = signatureGeneration_;
+                    flow->payloadState[0] = flow->payloadState[1] = 0;
+                }
+                SignatureEngine::Stream stream;
+                stream.state = flow->payloadState[reverse ? 1 : 0];
+                signatures_->Scan(stream, packet.payload, packet.payloadLength,
+                                  [&signatureHits](const SignatureEngine::Match& match) {
+                                      signatureHits.push_back(match.signature);
+                                  });
+                flow->payloadState[reverse ? 1 : 0] = stream.state;
+                if (!signatureHits.empty()) {
+                    signatures = signatures_;
+                }
+            }
+        }
+
+        if (timestamp - packetScanTime_ >= kPacketScanInterval) {
+            ScanPacketHalfOpen(timestamp);
+        }
+    }
+
+    if (newFlow) {
+        AnalyzeConnectionPattern(conn, true, detectorTime);
+    }
+    if (!signatureHits.empty()) {
+        ReportSignatureHits(packet, *signatures, signatureHits);
+    }
+    if (!synAlerts_.empty()) {
+        ReportSynFloods();
+    }
+}
+
+void NetworkMonitor::FlushPacketStats() {
+    {
+        std::lock_guard<std::mutex> lock(flowMutex_);
+        ScanPacketHalfOpen(packetTotals_.timestamp);
+    }
+    ReportSynFloods();
+
+    std::lock_guard<std::mutex> lock(flowMutex_);
+    RecordPacketSecond();
+    packetSecond_ = TrafficStats();
+}
+
+void NetworkMonitor::RecordPacketSecond() {
+    if (packetSecond_.packetsReceived == 0) {
+        return;
+    }
     std::lock_guard<std::mutex> lock(statsMutex_);
-    
-    auto cutoff = std::chrono::system_clock::now() - std::chrono::minutes(minutes);
+    statsHistory_.Record(packetSecond_.timestamp, {
+        static_cast<double>(packetSecond_.bytesReceived),
+        static_cast<double>(packetSecond_.bytesSent),
+        static_cast<double>(packetSecond_.packetsReceived),
+        static_cast<double>(packetSecond_.packetsSent),
+        static_cast<double>(flows_.Size()),
+        static_cast<double>(flows_.GetTotalCreated())
+    });
+}
+
+std::vector<NetworkMonitor::TrafficStats> NetworkMonitor::GetStatsHistory(int minutes) const {
+    std::vector<TrafficSeries::Point> points = GetStatsSeries(minutes);
+
     std::vector<TrafficStats> result;
-    
-    for (const auto& stats : statsHistory_) {
-        if (stats.timestamp >= cutoff) {
-            result.push_back(stats);
-        }
+    result.reserve(points.size());
+    for (const auto& point : points) {
+        TrafficStats stats;
+        stats.bytesReceived = static_cast<uint64_t>(point.Mean(FieldBytesReceived));
+        stats.bytesSent = static_cast<uint64_t>(point.Mean(FieldBytesSent));
+        stats.packetsReceived = static_cast<uint32_t>(point.Mean(FieldPacketsReceived));
+        stats.packetsSent = static_cast<uint32_t>(point.Mean(FieldPacketsSent));
+        stats.connectionsActive = static_cast<uint32_t>(point.Mean(FieldConnectionsActive));
+        stats.connectionsTotal = static_cast<uint32_t>(point.Mean(FieldConnectionsTotal));
+        stats.timestamp = point.start;
+        result.push_back(stats);
     }
-    
     return result;
 }
 
+std::vector<NetworkMonitor::TrafficSeries::Point> NetworkMonitor::GetStatsSeries(int minutes) const {
+    auto now = std::chrono::system_clock::now();
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    return statsHistory_.Query(now - std::chrono::minutes(minutes), now);
+}
+
+namespace {
+
+std::vector<std::string> ToStrings(const IPPrefixSet& prefixes) {
+    auto entries = prefixes.GetPrefixes();
+    std::vector<std::string> result;
+    result.reserve(entries.size());
+    for (const auto& entry : entries) {
+        result.push_back(entry.ToString());
+    }
+    return result;
+}
+
+int FullLength(const IPAddress& ip) {
+    return ip.IsIPv4() ? 32 : 128;
+}
+
+} // namespace
+
 std::vector<std::string> NetworkMonitor::GetSuspiciousIPs() const {
-    return std::vector<std::string>(suspiciousIPs_.begin(), suspiciousIPs_.end());
+    std::lock_guard<std::mutex> lock(threatMutex_);
+    return ToStrings(suspiciousIPs_);
 }
 
 int NetworkMonitor::GetThreatCount() const {
-    return static_cast<int>(suspiciousIPs_.size());
+    std::lock_guard<std::mutex> lock(threatMutex_);
+    return static_cast<int>(suspiciousIPs_.Size());
+}
+
+void NetworkMonitor::BlockIP(const IPAddress& ip, int prefixLength) {
+    if (prefixLength < 0) {
+        prefixLength = FullLength(ip);
+    }
+    bool added;
+    {
+        std::lock_guard<std::mutex> lock(threatMutex_);
+        added = blockedIPs_.Insert(ip, prefixLength);
+    }
+    if (added) {
+        AddNetworkLog(IPAddress(), ip, "BLOCK",
+                      prefixLength == FullLength(ip) ? "IP Blocked"
+                                                     : "IP Range Blocked (/" + std::to_string(prefixLength) + ")",
+                      "BLOCKED", 2);
+    }
 }
 
 void NetworkMonitor::BlockIP(const std::string& ip) {
-    blockedIPs_.insert(ip);
-    AddNetworkLog("SYSTEM", ip, "BLOCK", "IP Blocked", "BLOCKED");
+    IPAddress address;
+    int length;
+    if (IPPrefixSet::ParseCidr(ip, address, length)) {
+        BlockIP(address, length);
+    }
+}
+
+void NetworkMonitor::UnblockIP(const IPAddress& ip, int prefixLength) {
+    if (prefixLength < 0) {
+        prefixLength = FullLength(ip);
+    }
+    bool removed;
+    {
+        std::lock_guard<std::mutex> lock(threatMutex_);
+        removed = blockedIPs_.Remove(ip, prefixLength);
+    }
+    if (removed) {
+        AddNetworkLog(IPAddress(), ip, "UNBLOCK",
+                      prefixLength == FullLength(ip) ? "IP Unblocked"
+                                                     : "IP Range Unblocked (/" + std::to_string(prefixLength) + ")",
+                      "ALLOWED", 1);
+    }
 }
 
 void NetworkMonitor::UnblockIP(const std::string& ip) {
-    blockedIPs_.erase(ip);
-    AddNetworkLog("SYSTEM", ip, "UNBLOCK", "IP Unblocked", "ALLOWED");
+    IPAddress address;
+    int length;
+    if (IPPrefixSet::ParseCidr(ip, address, length)) {
+        UnblockIP(address, length);
+    }
+}
+
+bool NetworkMonitor::IsIPBlocked(const IPAddress& ip) const {
+    std::lock_guard<std::mutex> lock(threatMutex_);
+    return blockedIPs_.Contains(ip);
+}
+
+bool NetworkMonitor::IsIPBlocked(const std::string& ip) const {
+    IPAddress address;
+    return IPAddress::Parse(ip, address) && IsIPBlocked(address);
 }
 
 std::vector<std::string> NetworkMonitor::GetBlockedIPs() const {
-    return std::vector<std::string>(blockedIPs_.begin(), blockedIPs_.end());
+    std::lock_guard<std::mutex> lock(threatMutex_);
+    return ToStrings(blockedIPs_);
+}
+
+void NetworkMonitor::BlockDomain(const std::string& domain) {
+    bool added;
+    {
+        std::lock_guard<std::mutex> lock(threatMutex_);
+        added = blockedDomains_.Insert(domain);
+    }
+    if (added) {
+        AddNetworkLog(IPAddress(), IPAddress(), "BLOCK", "Domain Blocked: " + domain, "BLOCKED", 2);
+    }
+}
+
+void NetworkMonitor::UnblockDomain(const std::string& domain) {
+    bool removed;
+    {
+        std::lock_guard<std::mutex> lock(threatMutex_);
+        removed = blockedDomains_.Remove(domain);
+    }
+    if (removed) {
+        AddNetworkLog(IPAddress(), IPAddress(), "UNBLOCK", "Domain Unblocked: " + domain, "ALLOWED", 1);
+    }
+}
+
+bool NetworkMonitor::IsDomainBlocked(const std::string& hostname) const {
+    std::lock_guard<std::mutex> lock(threatMutex_);
+    return blockedDomains_.Contains(hostname);
+}
+
+std::vector<std::string> NetworkMonitor::GetBlockedDomains() const {
+    std::lock_guard<std::mutex> lock(threatMutex_);
+    return blockedDomains_.GetRules();
+}
+
+bool NetworkMonitor::IsIPSuspicious(const IPAddress& ip) const {
+    {
+        std::lock_guard<std::mutex> lock(threatMutex_);
+        if (suspiciousIPs_.Contains(ip) || blockedIPs_.Contains(ip)) {
+            return true;
+        }
+    }
+    auto intel = std::atomic_load(&threatIntel_);
+    return intel && intel->LookupIP(ip);
 }
 
 bool NetworkMonitor::IsIPSuspicious(const std::string& ip) const {
-    return suspiciousIPs_.find(ip) != suspiciousIPs_.end();
+    IPAddress address;
+    return IPAddress::Parse(ip, address) && IsIPSuspicious(address);
 }
 
-std::string NetworkMonitor::AnalyzeTrafficPattern(const std::string& ip) const {
-    auto it = ipActivity_.find(ip);
-    if (it == ipActivity_.end()) {
+std::string NetworkMonitor::AnalyzeTrafficPattern(const IPAddress& ip) const {
+    // A blocked host name outranks whatever the traffic looks like
+    const std::string hostname = Utils::GetHostname(ip.ToString());
+    IPAddress literal;
+    if (!IPAddress::Parse(hostname, literal)) {
+        std::string_view rule;
+        std::lock_guard<std::mutex> lock(threatMutex_);
+        if (blockedDomains_.Match(hostname, &rule)) {
+            return "Blocked domain " + hostname + " (matched " + std::string(rule) + ")";
+        }
+    }
+
+    double rate;
+    double fanout;
+    {
+        std::lock_guard<std::mutex> lock(activityMutex_);
+        rate = ipActivity_.Estimate(ip);
+        fanout = ipFanout_.Estimate(ip);
+    }
+    if (rate < 1.0 && fanout < 1.0) {
         return "No activity recorded";
     }
     
-    int count = it->second;
-    if (count > 100) {
-        return "High activity - possible DDoS";
-    } else if (count > 50) {
-        return "Moderate activity - monitoring recommended";
+    std::string result;
+    if (rate > kDDoSThreshold) {
+        result = "High activity - possible DDoS";
+    } else if (fanout > kPortScanFanoutThreshold) {
+        result = "Wide fan-out - possible port scan";
+    } else if (rate > kModerateActivityThreshold) {
+        result = "Moderate activity - monitoring recommended";
     } else {
-        return "Normal activity";
+        result = "Normal activity";
     }
+    result += " (~" + std::to_string(static_cast<long long>(fanout + 0.5)) + " distinct targets)";
+    return result;
+}
+
+std::string NetworkMonitor::AnalyzeTrafficPattern(const std::string& ip) const {
+    IPAddress address;
+    if (!IPAddress::Parse(ip, address)) {
+        return "Invalid IP address";
+    }
+    return AnalyzeTrafficPattern(address);
+}
+
+void NetworkMonitor::SetThreatIntelSources(const std::vector<std::string>& feedPaths,
+                                           const std::string& databasePath) {
+    std::lock_guard<std::mutex> lock(threatMutex_);
+    threatFeeds_ = feedPaths;
+    threatDatabasePath_ = databasePath;
+}
+
+std::shared_ptr<const ThreatIntelDB> NetworkMonitor::GetThreatIntel() const {
+    return std::atomic_load(&threatIntel_);
+}
+
+void NetworkMonitor::SetSignatureEngine(std::shared_ptr<const SignatureEngine> engine) {
+    std::lock_guard<std::mutex> lock(flowMutex_);
+    signatures_ = std::move(engine);
+    // Skip 0, the tag of newly created flows
+    if (++signatureGeneration_ == 0) {
+        signatureGeneration_ = 1;
+    }
+}
+
+std::shared_ptr<const SignatureEngine> NetworkMonitor::GetSignatureEngine() const {
+    std::lock_guard<std::mutex> lock(flowMutex_);
+    return signatures_;
 }
 
 void NetworkMonitor::UpdateThreatDatabase() {
-    // Placeholder for threat database updates
+    std::lock_guard<std::mutex> update(threatIntelUpdateMutex_);
+    std::vector<std::string> feeds;
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(threatMutex_);
+        feeds = threatFeeds_;
+        path = threatDatabasePath_;
+    }
+    if (path.empty()) {
+        return;
+    }
+
+    // An unchanged feed set keeps the mapped database; without feeds a
+    // prebuilt database is used as is
+    const uint64_t fingerprint = ThreatIntelDB::FeedFingerprint(feeds);
+    auto current = std::atomic_load(&threatIntel_);
+    if (current && (feeds.empty() || current->GetFeedFingerprint() == fingerprint)) {
+        return;
+    }
+    if (fingerprint == threatIntelFailed_) {
+        return;
+    }
+
+    // Reuse the compiled file from a previous run when it matches the feeds
+    auto db = std::make_shared<ThreatIntelDB>();
+    if (!db->Open(path) || (!feeds.empty() && db->GetFeedFingerprint() != fingerprint)) {
+        if (feeds.empty()) {
+            return;
+        }
+        ThreatIntelDB::CompileStats stats;
+        std::string error;
+        if (!ThreatIntelDB::Compile(feeds, path, &stats, error) || !db->Open(path)) {
+            threatIntelFailed_ = fingerprint;
+            AddNetworkLog(IPAddress(), IPAddress(), "INTEL",
+                          "Threat intel update failed: " + (error.empty() ? db->GetError() : error), "INFO", 1);
+            return;
+        }
+    }
+
+    const size_t indicators = db->GetIndicatorCount();
+    const size_t feedCount = db->GetFeedCount();
+    // Lookups already running keep their reference to the old mapping
+    std::atomic_store(&threatIntel_, std::shared_ptr<const ThreatIntelDB>(std::move(db)));
+    AddNetworkLog(IPAddress(), IPAddress(), "INTEL",
+                  "Threat intel loaded: " + std::to_string(indicators) + " indicators from " +
+                  std::to_string(feedCount) + " feeds", "INFO", 1);
 }
 
 void NetworkMonitor::MonitoringLoop() {
+    auto threatIntelChecked = std::chrono::steady_clock::now() - kThreatIntelCheckInterval;
     while (isMonitoring_) {
+        if (std::chrono::steady_clock::now() - threatIntelChecked >= kThreatIntelCheckInterval) {
+            UpdateThreatDatabase();
+            threatIntelChecked = std::chrono::steady_clock::now();
+        }
         ScanActiveConnections();
         AnalyzeTraffic();
         DetectThreats();
@@ -139,24 +593,46 @@ void NetworkMonitor::MonitoringLoop() {
 }
 
 void NetworkMonitor::ScanActiveConnections() {
+    auto start = std::chrono::steady_clock::now();
+    scanCount_ = 0;
+    lastScanBackend_ = ScanBackend::ProcFs;
     GetTcpTable();
     GetUdpTable();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    // Rows beyond scanCount_ are left over from a larger previous scan.
+    // Swapping rather than copying keeps both buffers' capacity for the next cycle.
+    if (scanBuffer_.size() > scanCount_) {
+        scanBuffer_.erase(scanBuffer_.begin() + scanCount_, scanBuffer_.end());
+    }
+    AnalyzeNewConnections();
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex_);
+        connections_.swap(scanBuffer_);
+
+        ScanTiming& timing = (lastScanBackend_ == ScanBackend::Netlink) ? netlinkTiming_ : procTiming_;
+        timing.scans++;
+        timing.connections = static_cast<uint32_t>(scanCount_);
+        timing.lastDuration = elapsed;
+        timing.averageDuration += (elapsed - timing.averageDuration) / static_cast<int64_t>(timing.scans);
+    }
 }
 
 void NetworkMonitor::AnalyzeTraffic() {
     // Store current stats
     auto stats = GetCurrentStats();
     {
+        // Rollup tiers age out old data on their own
         std::lock_guard<std::mutex> lock(statsMutex_);
-        statsHistory_.push_back(stats);
-        
-        // Keep only last hour of data
-        auto cutoff = std::chrono::system_clock::now() - std::chrono::hours(1);
-        statsHistory_.erase(
-            std::remove_if(statsHistory_.begin(), statsHistory_.end(),
-                          [cutoff](const TrafficStats& s) { return s.timestamp < cutoff; }),
-            statsHistory_.end()
-        );
+        statsHistory_.Record(stats.timestamp, {
+            static_cast<double>(stats.bytesReceived),
+            static_cast<double>(stats.bytesSent),
+            static_cast<double>(stats.packetsReceived),
+            static_cast<double>(stats.packetsSent),
+            static_cast<double>(stats.connectionsActive),
+            static_cast<double>(stats.connectionsTotal)
+        });
     }
 }
 
@@ -167,62 +643,234 @@ void NetworkMonitor::DetectThreats() {
     static std::uniform_int_distribution<> dis(1, 1000);
     
     if (dis(gen) > 990) { // 1% chance
-        std::string suspiciousIP = "192.168.1." + std::to_string(dis(gen) % 255);
-        suspiciousIPs_.insert(suspiciousIP);
-        AddNetworkLog(suspiciousIP, "192.168.1.100", "TCP", "Port Scan Detected", "BLOCKED");
+        IPAddress suspiciousIP = IPAddress::FromIPv4(0xC0A80100u | static_cast<uint32_t>(dis(gen) % 255));
+        {
+            std::lock_guard<std::mutex> lock(threatMutex_);
+            suspiciousIPs_.Insert(suspiciousIP, 32);
+        }
+        AddNetworkLog(suspiciousIP, IPAddress::FromIPv4(0xC0A80164u), "TCP", "Port Scan Detected", "BLOCKED");
     }
 }
 
-void NetworkMonitor::AnalyzeConnectionPattern(const NetworkConnection& conn) {
-    ipActivity_[conn.remoteAddress]++;
-    
-    if (IsPortScanDetected(conn.remoteAddress)) {
-        suspiciousIPs_.insert(conn.remoteAddress);
-        AddNetworkLog(conn.remoteAddress, conn.localAddress, conn.protocol, "Port Scan", "BLOCKED");
+void NetworkMonitor::AnalyzeNewConnections() {
+    const auto now = std::chrono::system_clock::now();
+
+    // A connection whose local port has a listener was accepted (inbound);
+    // anything else was initiated from this host (outbound)
+    listeningPorts_.clear();
+    for (size_t i = 0; i < scanCount_; ++i) {
+        const NetworkConnection& conn = scanBuffer_[i];
+        if (conn.remoteAddress.IsUnspecified() || conn.remotePort == 0) {
+            listeningPorts_.insert(ListenerKey(conn.protocol, conn.localPort));
+        }
+    }
+
+    // Every live socket refreshes its flow; only a newly created flow counts
+    // as activity, so a long-lived connection is not re-counted every cycle.
+    // Detectors run after the lock is released since they log and call out.
+    newConnections_.clear();
+    synAlerts_.clear();
+    {
+        std::lock_guard<std::mutex> lock(flowMutex_);
+        synFlood_.BeginScan();
+        for (size_t i = 0; i < scanCount_; ++i) {
+            const NetworkConnection& conn = scanBuffer_[i];
+            if (conn.remoteAddress.IsUnspecified() || conn.remotePort == 0) {
+                continue; // listening or unconnected socket
+            }
+            if (conn.protocol == Protocol::TCP && (conn.state == kTcpSynRecv || conn.state == kTcpNewSynRecv)) {
+                synFlood_.AddHalfOpen(conn.localAddress, conn.localPort, conn.remoteAddress);
+            }
+
+            bool inbound = listeningPorts_.count(ListenerKey(conn.protocol, conn.localPort)) != 0;
+            bool created;
+            FlowTable::Flow* flow = flows_.Update(FlowKeyOf(conn, inbound), 0, 0, now, created);
+            if (!flow) {
+                continue; // table full
+            }
+            flow->state = conn.state;
+            if (created) {
+                newConnections_.emplace_back(i, inbound);
+            }
+        }
+        synFlood_.EndScan(synAlerts_);
+        flows_.Expire(now);
     }
+
+    for (const auto& entry : newConnections_) {
+        AnalyzeConnectionPattern(scanBuffer_[entry.first], entry.second, RateSketch::Clock::now());
+    }
+    ReportSynFloods();
 }
 
-bool NetworkMonitor::IsPortScanDetected(const std::string& ip) const {
-    auto it = ipActivity_.find(ip);
-    return it != ipActivity_.end() && it->second > 20; // Threshold for port scan
+void NetworkMonitor::ScanPacketHalfOpen(std::chrono::system_clock::time_point now) {
+    // Caller holds flowMutex_. Packet flows still in SYN_RECV never saw the
+    // initiator's handshake ACK; idle expiry removes the abandoned ones.
+    synFlood_.BeginScan();
+    flows_.ForEach([this](const FlowTable::Flow& flow) {
+        if (flow.state == kTcpSynRecv && flow.key.protocol == PacketDecoder::kProtocolTcp) {
+            synFlood_.AddHalfOpen(flow.key.destination, flow.key.destinationPort, flow.key.source);
+        }
+    });
+    synFlood_.EndScan(synAlerts_);
+    packetScanTime_ = now;
 }
 
-bool NetworkMonitor::IsDDoSDetected(const std::string& ip) const {
-    auto it = ipActivity_.find(ip);
-    return it != ipActivity_.end() && it->second > 100; // Threshold for DDoS
+void NetworkMonitor::ReportSynFloods() {
+    for (const auto& alert : synAlerts_) {
+        for (const auto& source : alert.topSources) {
+            {
+                std::lock_guard<std::mutex> lock(threatMutex_);
+                suspiciousIPs_.Insert(source.prefix.address, source.prefix.length);
+            }
+            AddNetworkLog(source.prefix.address, alert.listenerAddress, "TCP",
+                          "SYN Flood on port " + std::to_string(alert.listenerPort) + " from " +
+                          source.prefix.ToString() + " (" + std::to_string(source.halfOpen) + " of " +
+                          std::to_string(alert.halfOpen) + " half-open)",
+                          "BLOCKED", 4);
+        }
+    }
+    synAlerts_.clear();
 }
 
+void NetworkMonitor::ReportSignatureHits(const PacketDecoder::Packet& packet, const SignatureEngine& signatures,
+                                         const std::vector<uint32_t>& hits) {
+    bool added;
+    {
+        std::lock_guard<std::mutex> lock(threatMutex_);
+        added = suspiciousIPs_.Insert(packet.sourceIp, FullLength(packet.sourceIp));
+    }
+    if (added) {
+        const char* protocol = packet.ipProtocol == PacketDecoder::kProtocolTcp ? "TCP" : "UDP";
+        AddNetworkLog(packet.sourceIp, packet.destinationIp, protocol,
+                      "Payload signature " + signatures.GetSignatureName(hits.front()) + " (port " +
+                      std::to_string(packet.destinationPort) + ")", "BLOCKED", 4);
+    }
+}
+
+void NetworkMonitor::AnalyzeConnectionPattern(const NetworkConnection& conn, bool inbound,
+                                              RateSketch::Clock::time_point now) {
+    // Inbound: the remote peer is probing our (address, port) pairs.
+    // Outbound: a local process is fanning out across remote targets.
+    const IPAddress& source = inbound ? conn.remoteAddress : conn.localAddress;
+    const IPAddress& target = inbound ? conn.localAddress : conn.remoteAddress;
+    const uint16_t targetPort = inbound ? conn.localPort : conn.remotePort;
+    {
+        std::lock_guard<std::mutex> lock(activityMutex_);
+        ipFanout_.Add(source, target, targetPort, now);
+        if (inbound) {
+            ipActivity_.Add(source, 1.0, now);
+        }
+    }
+    
+    // Listed remote peers, whichever side opened the connection
+    if (auto intel = std::atomic_load(&threatIntel_)) {
+        ThreatIntelDB::Match match;
+        if (intel->LookupIP(conn.remoteAddress, &match)) {
+            bool added;
+            {
+                std::lock_guard<std::mutex> lock(threatMutex_);
+                added = suspiciousIPs_.Insert(conn.remoteAddress, FullLength(conn.remoteAddress));
+            }
+            if (added) {
+                AddNetworkLog(source, target, conn.GetProtocolName(),
+                              "Threat Intel match (" + std::string(match.feed) + ")", "BLOCKED", 4);
+            }
+        }
+    }
+
+    const char* threat = nullptr;
+    int severity = 3;
+    if (inbound && IsDDoSDetected(source, now)) {
+        threat = "Possible DDoS";
+        severity = 4;
+    } else if (IsPortScanDetected(source)) {
+        threat = inbound ? "Port Scan" : "Outbound Port Scan";
+    }
+
+    if (threat) {
+        bool added;
+        {
+            std::lock_guard<std::mutex> lock(threatMutex_);
+            added = suspiciousIPs_.Insert(source, FullLength(source));
+        }
+        if (added) {
+            AddNetworkLog(source, target, conn.GetProtocolName(), threat, "BLOCKED", severity);
+        }
+    }
+}
+
+bool NetworkMonitor::IsPortScanDetected(const IPAddress& ip) const {
+    std::lock_guard<std::mutex> lock(activityMutex_);
+    return ipFanout_.Estimate(ip) > kPortScanFanoutThreshold;
+}
+
+bool NetworkMonitor::IsDDoSDetected(const IPAddress& ip, RateSketch::Clock::time_point now) const {
+    std::lock_guard<std::mutex> lock(activityMutex_);
+    return ipActivity_.Estimate(ip, now) > kDDoSThreshold;
+}
 void NetworkMonitor::GetTcpTable() {
+#ifdef __linux__
+    ReadSocketTable(static_cast<int>(LinuxConnectionTable::Table::Tcp));
+    ReadSocketTable(static_cast<int>(LinuxConnectionTable::Table::Tcp6));
+#else
     // Windows API implementation would go here
+#endif
 }
 
 void NetworkMonitor::GetUdpTable() {
+#ifdef __linux__
+    ReadSocketTable(static_cast<int>(LinuxConnectionTable::Table::Udp));
+    ReadSocketTable(static_cast<int>(LinuxConnectionTable::Table::Udp6));
+#else
     // Windows API implementation would go here
+#endif
+}
+
+void NetworkMonitor::ReadSocketTable(int tableIndex) {
+    auto table = static_cast<LinuxConnectionTable::Table>(tableIndex);
+    uint32_t stateMask = stateFilter_.load();
+    ScanBackend backend = scanBackend_.load();
+
+    if (backend != ScanBackend::ProcFs && !netlinkUnavailable_.load()) {
+        size_t written = 0;
+        if (sockDiag_->Open() &&
+            sockDiag_->Dump(table, stateMask, scanBuffer_, scanCount_, written)) {
+            scanCount_ += written;
+            lastScanBackend_ = ScanBackend::Netlink;
+            return;
+        }
+        // sock_diag missing (old kernel, seccomp, non-Linux): stay on /proc from now on
+        sockDiag_->Close();
+        netlinkUnavailable_.store(true);
+        AddNetworkLog(IPAddress(), IPAddress(), "NETLINK", "sock_diag unavailable, using /proc/net", "INFO", 1);
+    }
+
+    scanCount_ += connectionTable_->Read(table, scanBuffer_, scanCount_, stateMask);
+    lastScanBackend_ = ScanBackend::ProcFs;
 }
 
 void NetworkMonitor::GetNetworkStatistics() {
     // Windows API implementation would go here
 }
 
-void NetworkMonitor::AddNetworkLog(const std::string& sourceIp, const std::string& destIp,
+void NetworkMonitor::AddNetworkLog(const IPAddress& sourceIp, const IPAddress& destIp,
                                   const std::string& protocol, const std::string& threat,
-                                  const std::string& status) {
+                                  const std::string& status, int severity) {
     NetworkLog log;
-    log.id = nextLogId_++;
+    log.id = nextLogId_.fetch_add(1, std::memory_order_relaxed);
     log.timestamp = std::chrono::system_clock::now();
     log.sourceIp = sourceIp;
     log.destinationIp = destIp;
     log.protocol = protocol;
     log.threat = threat;
     log.status = status;
-    
-    {
-        std::lock_guard<std::mutex> lock(logsMutex_);
-        logs_.push_back(log);
-        
-        // Keep only last 1000 logs
-        if (logs_.size() > 1000) {
-            logs_.erase(logs_.begin(), logs_.begin() + 100);
-        }
+    log.severity = severity;
+
+    if (threatCallback_) {
+        threatCallback_(log);
     }
+    
+    // The ring overwrites the oldest entry once it is full
+    logs_.Push(std::move(log));
 }
\ No newline at end of file
@@ -0,0 +1,167 @@
+#include "PacketDecoder.h"
+
+namespace {
+
+constexpr uint16_t kEtherTypeIPv4 = 0x0800;
+constexpr uint16_t kEtherTypeIPv6 = 0x86DD;
+constexpr uint16_t kEtherTypeVlan = 0x8100;
+constexpr uint16_t kEtherTypeQinQ = 0x88A8;
+
+inline uint16_t Read16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+inline uint32_t ReadHost32(const uint8_t* p) {
+    // BSD loopback stores the address family in the capturing host's byte order
+    uint32_t little = p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    return little > 0xFFFF ? (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3] : little;
+}
+
+} // namespace
+
+bool PacketDecoder::Decode(uint32_t linkType, const uint8_t* data, size_t length, Packet& out) {
+    out.sourcePort = 0;
+    out.destinationPort = 0;
+    out.ipProtocol = 0;
+    out.tcpFlags = 0;
+    out.hasTransport = false;
+    out.payload = nullptr;
+    out.payloadLength = 0;
+
+    uint16_t etherType;
+    size_t offset;
+    switch (linkType) {
+    case LinkEthernet:
+        if (length < 14) return false;
+        etherType = Read16(data + 12);
+        offset = 14;
+        // Up to two stacked 802.1Q / 802.1ad tags
+        for (int tags = 0; tags < 2 && (etherType == kEtherTypeVlan || etherType == kEtherTypeQinQ); ++tags) {
+            if (length < offset + 4) return false;
+            etherType = Read16(data + offset + 2);
+            offset += 4;
+        }
+        break;
+    case LinkLinuxSll:
+        if (length < 16) return false;
+        etherType = Read16(data + 14);
+        offset = 16;
+        break;
+    case LinkLinuxSll2:
+        if (length < 20) return false;
+        etherType = Read16(data);
+        offset = 20;
+        break;
+    case LinkNull: {
+        if (length < 4) return false;
+        uint32_t family = ReadHost32(data);
+        // AF_INET is 2 everywhere; AF_INET6 is 10, 24, 28 or 30 depending on the OS
+        etherType = family == 2 ? kEtherTypeIPv4 : kEtherTypeIPv6;
+        offset = 4;
+        break;
+    }
+    case LinkRaw:
+    case LinkIPv4:
+    case LinkIPv6:
+        if (length < 1) return false;
+        etherType = (data[0] >> 4) == 6 ? kEtherTypeIPv6 : kEtherTypeIPv4;
+        offset = 0;
+        break;
+    default:
+        return false;
+    }
+
+    if (etherType == kEtherTypeIPv4) {
+        return DecodeIPv4(data + offset, length - offset, out);
+    }
+    if (etherType == kEtherTypeIPv6) {
+        return DecodeIPv6(data + offset, length - offset, out);
+    }
+    return false;
+}
+
+bool PacketDecoder::DecodeIPv4(const uint8_t* data, size_t length, Packet& out) {
+    if (length < 20 || (data[0] >> 4) != 4) return false;
+    size_t headerLength = static_cast<size_t>(data[0] & 0x0F) * 4;
+    if (headerLength < 20 || length < headerLength) return false;
+
+    out.sourceIp = IPAddress::FromIPv4Bytes(data + 12);
+    out.destinationIp = IPAddress::FromIPv4Bytes(data + 16);
+    out.ipProtocol = data[9];
+
+    // Trust the smaller of the IP total length and the captured bytes (snaplen, padding)
+    size_t totalLength = Read16(data + 2);
+    if (totalLength >= headerLength && totalLength < length) {
+        length = totalLength;
+    }
+
+    // Only the first fragment carries the transport header
+    uint16_t fragmentOffset = Read16(data + 6) & 0x1FFF;
+    if (fragmentOffset == 0) {
+        DecodeTransport(out.ipProtocol, data + headerLength, length - headerLength, out);
+    }
+    return true;
+}
+
+bool PacketDecoder::DecodeIPv6(const uint8_t* data, size_t length, Packet& out) {
+    if (length < 40 || (data[0] >> 4) != 6) return false;
+
+    out.sourceIp = IPAddress::FromIPv6Bytes(data + 8);
+    out.destinationIp = IPAddress::FromIPv6Bytes(data + 24);
+
+    size_t payloadLength = Read16(data + 4);
+    if (payloadLength > 0 && 40 + payloadLength < length) {
+        length = 40 + payloadLength;
+    }
+
+    uint8_t next = data[6];
+    size_t offset = 40;
+    // Skip extension headers until a transport protocol (bounded to avoid loops on junk)
+    for (int hops = 0; hops < 8; ++hops) {
+        if (next == 0 || next == 43 || next == 60) { // hop-by-hop, routing, destination options
+            if (length < offset + 8) return true;
+            uint8_t following = data[offset];
+            offset += (static_cast<size_t>(data[offset + 1]) + 1) * 8;
+            next = following;
+        } else if (next == 44) { // fragment
+            if (length < offset + 8) return true;
+            uint16_t fragmentOffset = Read16(data + offset + 2) & 0xFFF8;
+            uint8_t following = data[offset];
+            offset += 8;
+            next = following;
+            if (fragmentOffset != 0) {
+                out.ipProtocol = next;
+                return true;
+            }
+        } else {
+            break;
+        }
+    }
+
+    out.ipProtocol = next;
+    if (offset <= length) {
+        DecodeTransport(next, data + offset, length - offset, out);
+    }
+    return true;
+}
+
+void PacketDecoder::DecodeTransport(uint8_t protocol, const uint8_t* data, size_t length, Packet& out) {
+    if (protocol == kProtocolTcp) {
+        if (length < 20) return;
+        size_t headerLength = static_cast<size_t>(data[12] >> 4) * 4;
+        if (headerLength < 20 || length < headerLength) return;
+        out.sourcePort = Read16(data);
+        out.destinationPort = Read16(data + 2);
+        out.tcpFlags = data[13];
+        out.payload = data + headerLength;
+        out.payloadLength = static_cast<uint32_t>(length - headerLength);
+        out.hasTransport = true;
+    } else if (protocol == kProtocolUdp) {
+        if (length < 8) return;
+        out.sourcePort = Read16(data);
+        out.destinationPort = Read16(data + 2);
+        out.payload = data + 8;
+        out.payloadLength = static_cast<uint32_t>(length - 8);
+        out.hasTransport = true;
+    }
+}
@@ -0,0 +1,231 @@
+#include "PcapReader.h"
+#include <cstring>
+
+namespace {
+
+constexpr uint32_t kPcapMagicMicro = 0xA1B2C3D4;
+constexpr uint32_t kPcapMagicNano = 0xA1B23C4D;
+constexpr uint32_t kPcapNgSection = 0x0A0D0D0A;
+constexpr uint32_t kPcapNgByteOrder = 0x1A2B3C4D;
+
+constexpr uint32_t kBlockInterface = 0x00000001;
+constexpr uint32_t kBlockSimplePacket = 0x00000003;
+constexpr uint32_t kBlockEnhancedPacket = 0x00000006;
+constexpr uint16_t kOptionTsResolution = 9;
+constexpr uint16_t kOptionTsOffset = 14;
+
+// Values are assembled byte-wise so parsing is independent of host byte order
+inline uint32_t LittleEndian32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline uint32_t BigEndian32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+} // namespace
+
+PcapReader::PcapReader()
+    : offset_(0), pcapng_(false), swapped_(false), nanosecond_(false), linkType_(0) {
+}
+
+uint16_t PcapReader::Read16(const uint8_t* p) const {
+    return swapped_ ? static_cast<uint16_t>((p[0] << 8) | p[1]) : static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t PcapReader::Read32(const uint8_t* p) const {
+    return swapped_ ? BigEndian32(p) : LittleEndian32(p);
+}
+
+bool PcapReader::Open(const std::string& path) {
+    Close();
+    if (!file_.Open(path, true)) {
+        error_ = file_.GetError();
+        return false;
+    }
+
+    const uint8_t* data = file_.Data();
+    const size_t size = file_.Size();
+    if (size < 24) {
+        error_ = "File too small to be a capture";
+        file_.Close();
+        return false;
+    }
+
+    const uint32_t magic = LittleEndian32(data);
+    if (magic == kPcapNgSection) {
+        pcapng_ = true;
+        return true; // section header is parsed as the first block
+    }
+
+    if (magic == kPcapMagicMicro || magic == kPcapMagicNano) {
+        swapped_ = false;
+    } else if (BigEndian32(data) == kPcapMagicMicro || BigEndian32(data) == kPcapMagicNano) {
+        swapped_ = true;
+    } else {
+        error_ = "Unknown capture format";
+        file_.Close();
+        return false;
+    }
+    nanosecond_ = Read32(data) == kPcapMagicNano;
+    linkType_ = Read32(data + 20) & 0x0FFFFFFF; // upper bits carry FCS flags
+    offset_ = 24;
+    return true;
+}
+
+void PcapReader::Close() {
+    file_.Close();
+    offset_ = 0;
+    pcapng_ = false;
+    swapped_ = false;
+    nanosecond_ = false;
+    linkType_ = 0;
+    interfaces_.clear();
+    error_.clear();
+}
+
+bool PcapReader::Next(Packet& packet) {
+    if (!file_.IsOpen()) {
+        return false;
+    }
+    return pcapng_ ? NextPcapNg(packet) : NextPcap(packet);
+}
+
+bool PcapReader::NextPcap(Packet& packet) {
+    const size_t size = file_.Size();
+    if (offset_ + 16 > size) {
+        return false;
+    }
+
+    const uint8_t* header = file_.Data() + offset_;
+    const uint32_t seconds = Read32(header);
+    const uint32_t fraction = Read32(header + 4);
+    const uint32_t captured = Read32(header + 8);
+    if (captured > size - offset_ - 16) {
+        error_ = "Truncated packet record";
+        return false;
+    }
+
+    packet.timestampNs = static_cast<uint64_t>(seconds) * 1000000000ull +
+                         (nanosecond_ ? fraction : static_cast<uint64_t>(fraction) * 1000ull);
+    packet.linkType = linkType_;
+    packet.capturedLength = captured;
+    packet.originalLength = Read32(header + 12);
+    packet.data = header + 16;
+    offset_ += 16 + captured;
+    return true;
+}
+
+bool PcapReader::NextPcapNg(Packet& packet) {
+    const uint8_t* data = file_.Data();
+    const size_t size = file_.Size();
+
+    while (offset_ + 12 <= size) {
+        const uint8_t* block = data + offset_;
+
+        // A section header may switch byte order, so it is recognised before Read32
+        if (LittleEndian32(block) == kPcapNgSection) {
+            if (!ParseSectionHeader(block, size - offset_)) {
+                return false;
+            }
+        }
+
+        const uint32_t type = Read32(block);
+        const uint32_t length = Read32(block + 4);
+        if (length < 12 || (length & 3) != 0 || length > size - offset_) {
+            error_ = "Malformed pcapng block";
+            return false;
+        }
+        offset_ += length;
+
+        if (type == kBlockInterface) {
+            ParseInterface(block, length);
+        } else if (type == kBlockEnhancedPacket && length >= 32) {
+            const uint32_t interfaceId = Read32(block + 8);
+            const uint32_t captured = Read32(block + 20);
+            if (interfaceId >= interfaces_.size() || captured > length - 32) {
+                continue;
+            }
+            const Interface& iface = interfaces_[interfaceId];
+            const uint64_t ticks = (static_cast<uint64_t>(Read32(block + 12)) << 32) | Read32(block + 16);
+            const uint64_t whole = ticks / iface.ticksPerSecond;
+            const uint64_t rest = ticks % iface.ticksPerSecond;
+
+            // Integer math is exact up to nanosecond resolution; finer clocks would overflow it
+            const uint64_t fraction = iface.ticksPerSecond <= 1000000000ull
+                ? rest * 1000000000ull / iface.ticksPerSecond
+                : static_cast<uint64_t>(static_cast<double>(rest) * 1e9 / static_cast<double>(iface.ticksPerSecond));
+            packet.timestampNs = (whole + iface.offsetSeconds) * 1000000000ull + fraction;
+            packet.linkType = iface.linkType;
+            packet.capturedLength = captured;
+            packet.originalLength = Read32(block + 24);
+            packet.data = block + 28;
+            return true;
+        } else if (type == kBlockSimplePacket && length >= 16 && !interfaces_.empty()) {
+            // Simple packets carry no timestamp and are truncated to the interface snaplen
+            const uint32_t original = Read32(block + 8);
+            const uint32_t available = length - 16;
+            packet.timestampNs = 0;
+            packet.linkType = interfaces_[0].linkType;
+            packet.capturedLength = original < available ? original : available;
+            packet.originalLength = original;
+            packet.data = block + 12;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PcapReader::ParseSectionHeader(const uint8_t* block, size_t length) {
+    if (length < 28) {
+        error_ = "Truncated pcapng section header";
+        return false;
+    }
+    if (LittleEndian32(block + 8) == kPcapNgByteOrder) {
+        swapped_ = false;
+    } else if (BigEndian32(block + 8) == kPcapNgByteOrder) {
+        swapped_ = true;
+    } else {
+        error_ = "Bad pcapng byte-order magic";
+        return false;
+    }
+    interfaces_.clear(); // interface ids are scoped to their section
+    return true;
+}
+
+void PcapReader::ParseInterface(const uint8_t* block, size_t length) {
+    Interface iface;
+    iface.linkType = length >= 20 ? Read16(block + 8) : 0;
+    iface.ticksPerSecond = 1000000;
+    iface.offsetSeconds = 0;
+
+    // Options run from after the fixed fields to before the trailing length
+    size_t offset = 16;
+    while (offset + 4 <= length - 4) {
+        const uint16_t code = Read16(block + offset);
+        const uint16_t optionLength = Read16(block + offset + 2);
+        const uint8_t* value = block + offset + 4;
+        if (code == 0 || offset + 4 + optionLength > length - 4) {
+            break;
+        }
+        if (code == kOptionTsResolution && optionLength >= 1) {
+            // High bit set: negative power of two; otherwise a negative power of ten
+            const uint8_t resolution = value[0];
+            const uint8_t exponent = resolution & 0x7F;
+            uint64_t ticks = 1;
+            if (resolution & 0x80) {
+                ticks = exponent < 63 ? (1ull << exponent) : ticks;
+            } else {
+                for (uint8_t i = 0; i < exponent && i < 19; ++i) ticks *= 10;
+            }
+            iface.ticksPerSecond = ticks;
+        } else if (code == kOptionTsOffset && optionLength >= 8) {
+            uint32_t first = Read32(value);
+            uint32_t second = Read32(value + 4);
+            iface.offsetSeconds = swapped_ ? (static_cast<uint64_t>(first) << 32) | second
+                                           : (static_cast<uint64_t>(second) << 32) | first;
+        }
+        offset += 4 + ((optionLength + 3u) & ~3u);
+    }
+    interfaces_.push_back(iface);
+}
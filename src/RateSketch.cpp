@@ -0,0 +1,85 @@
+#include "RateSketch.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Counters grow as exp(age / window) under forward decay; rescale well
+// before float loses range (e^30 ~ 1e13)
+constexpr double kMaxAgeInWindows = 30.0;
+
+size_t RoundUpPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) result <<= 1;
+    return result;
+}
+
+} // namespace
+
+RateSketch::RateSketch(std::chrono::seconds window, size_t width, size_t depth)
+    : window_(window.count() > 0 ? window : std::chrono::seconds(1)),
+      inverseWindow_(1.0 / static_cast<double>(window_.count())),
+      width_(RoundUpPowerOfTwo(std::max<size_t>(width, 64))),
+      depth_(std::max<size_t>(depth, 1)),
+      counters_(width_ * depth_, 0.0f),
+      landmark_(Clock::now()) {
+}
+
+void RateSketch::Add(const IPAddress& source, double count, Clock::time_point now) {
+    if (Age(now) > kMaxAgeInWindows) {
+        Rescale(now);
+    }
+
+    // Forward decay: weight new events up instead of decaying every counter
+    const float weighted = static_cast<float>(count * std::exp(Age(now)));
+    const uint64_t hash = source.Hash();
+
+    float minimum = std::numeric_limits<float>::max();
+    for (size_t row = 0; row < depth_; ++row) {
+        minimum = std::min(minimum, counters_[Cell(hash, row)]);
+    }
+
+    // Conservative update: raise only the cells that would otherwise under-count
+    const float target = minimum + weighted;
+    for (size_t row = 0; row < depth_; ++row) {
+        float& cell = counters_[Cell(hash, row)];
+        if (cell < target) {
+            cell = target;
+        }
+    }
+}
+
+double RateSketch::Estimate(const IPAddress& source, Clock::time_point now) const {
+    const uint64_t hash = source.Hash();
+
+    float minimum = std::numeric_limits<float>::max();
+    for (size_t row = 0; row < depth_; ++row) {
+        minimum = std::min(minimum, counters_[Cell(hash, row)]);
+    }
+    return static_cast<double>(minimum) * std::exp(-Age(now));
+}
+
+void RateSketch::Clear() {
+    std::fill(counters_.begin(), counters_.end(), 0.0f);
+    landmark_ = Clock::now();
+}
+
+double RateSketch::Age(Clock::time_point now) const {
+    return std::chrono::duration<double>(now - landmark_).count() * inverseWindow_;
+}
+
+void RateSketch::Rescale(Clock::time_point now) {
+    const float factor = static_cast<float>(std::exp(-Age(now)));
+    for (float& cell : counters_) {
+        cell *= factor;
+    }
+    landmark_ = now;
+}
+
+size_t RateSketch::Cell(uint64_t hash, size_t row) const {
+    // Kirsch-Mitzenmacher double hashing: h1 + row * h2 gives independent-enough rows
+    const uint64_t h1 = hash;
+    const uint64_t h2 = (hash >> 32) | 1u;
+    return row * width_ + static_cast<size_t>((h1 + row * h2 * 0x9E3779B97F4A7C15ull) & (width_ - 1));
+}
@@ -0,0 +1,322 @@
+#include "Scheduler.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+constexpr uint64_t kNever = std::numeric_limits<uint64_t>::max();
+
+} // namespace
+
+Scheduler::Scheduler()
+    : Scheduler(Config()) {
+}
+
+Scheduler::Scheduler(const Config& config)
+    : config_(config), epoch_(Clock::now()), currentTick_(0),
+      started_(false), stopping_(false), random_(std::random_device{}()) {
+    if (config_.tick.count() <= 0) {
+        config_.tick = std::chrono::milliseconds(1);
+    }
+}
+
+Scheduler::~Scheduler() {
+    Stop();
+}
+
+uint64_t Scheduler::TickAt(Clock::time_point time) const {
+    if (time <= epoch_) {
+        return 0;
+    }
+    return static_cast<uint64_t>((time - epoch_) / config_.tick);
+}
+
+uint64_t Scheduler::TicksFor(std::chrono::milliseconds duration) const {
+    // Round up, so a job never runs sooner than asked
+    const int64_t tick = config_.tick.count();
+    return static_cast<uint64_t>(std::max<int64_t>(1, (duration.count() + tick - 1) / tick));
+}
+
+Scheduler::JobId Scheduler::AddJob(const std::string& name, std::chrono::milliseconds interval,
+                                   std::chrono::milliseconds jitter, Task task) {
+    if (!task || interval.count() <= 0) {
+        return kInvalidJob;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    Job job;
+    job.id = static_cast<JobId>(jobs_.size() + 1);
+    job.name = name;
+    job.task = std::move(task);
+    job.interval = interval;
+    job.jitter = std::max(jitter, std::chrono::milliseconds(0));
+    job.base = 0;
+    job.expiry = 0;
+    job.generation = 0;
+    job.queued = false;
+    job.running = false;
+    job.runs = 0;
+    job.missedDeadlines = 0;
+    job.failures = 0;
+    job.lastDuration = std::chrono::microseconds(0);
+    job.maxDuration = std::chrono::microseconds(0);
+    jobs_.push_back(std::move(job));
+
+    if (started_) {
+        Arm(jobs_.size() - 1, TickAt(Clock::now()) + TicksFor(interval));
+        timerWake_.notify_one();
+    }
+    return jobs_.back().id;
+}
+
+bool Scheduler::RemoveJob(JobId id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (id == kInvalidJob || id > jobs_.size() || jobs_[id - 1].id == kInvalidJob) {
+        return false;
+    }
+    Job& job = jobs_[id - 1];
+    job.id = kInvalidJob;
+    job.generation++;
+    job.task = nullptr;  // a running worker holds its own copy
+    return true;
+}
+
+bool Scheduler::SetInterval(JobId id, std::chrono::milliseconds interval, std::chrono::milliseconds jitter) {
+    if (interval.count() <= 0) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (id == kInvalidJob || id > jobs_.size() || jobs_[id - 1].id == kInvalidJob) {
+        return false;
+    }
+    Job& job = jobs_[id - 1];
+    job.interval = interval;
+    job.jitter = std::max(jitter, std::chrono::milliseconds(0));
+    if (started_) {
+        Arm(id - 1, currentTick_ + TicksFor(interval));
+        timerWake_.notify_one();
+    }
+    return true;
+}
+
+bool Scheduler::Start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (started_) {
+        return true;
+    }
+
+    started_ = true;
+    epoch_ = Clock::now();
+    currentTick_ = 0;
+    for (size_t i = 0; i < jobs_.size(); ++i) {
+        if (jobs_[i].id != kInvalidJob) {
+            Arm(i, TicksFor(jobs_[i].interval));
+        }
+    }
+
+    timerThread_ = std::thread(&Scheduler::TimerLoop, this);
+    const size_t count = std::max<size_t>(config_.workers, 1);
+    for (size_t i = 0; i < count; ++i) {
+        workers_.emplace_back(&Scheduler::WorkerLoop, this);
+    }
+    return true;
+}
+
+void Scheduler::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!started_ || stopping_) {
+            return;
+        }
+        stopping_ = true;
+    }
+    timerWake_.notify_all();
+    workReady_.notify_all();
+
+    timerThread_.join();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ready_.clear();
+    for (auto& level : wheel_) {
+        for (auto& slot : level) {
+            slot.clear();
+        }
+    }
+    for (Job& job : jobs_) {
+        job.queued = false;
+        job.running = false;
+    }
+    started_ = false;
+    stopping_ = false;
+}
+
+bool Scheduler::IsRunning() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return started_ && !stopping_;
+}
+
+bool Scheduler::IsStopping() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stopping_;
+}
+
+std::vector<Scheduler::JobStats> Scheduler::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<JobStats> stats;
+    for (const Job& job : jobs_) {
+        if (job.id == kInvalidJob) {
+            continue;
+        }
+        JobStats entry;
+        entry.name = job.name;
+        entry.interval = job.interval;
+        entry.jitter = job.jitter;
+        entry.runs = job.runs;
+        entry.missedDeadlines = job.missedDeadlines;
+        entry.failures = job.failures;
+        entry.lastDuration = job.lastDuration;
+        entry.maxDuration = job.maxDuration;
+        entry.running = job.running;
+        stats.push_back(std::move(entry));
+    }
+    return stats;
+}
+
+void Scheduler::Arm(size_t index, uint64_t base) {
+    Job& job = jobs_[index];
+    uint64_t expiry = base;
+    const uint64_t jitterTicks = static_cast<uint64_t>(job.jitter / config_.tick);
+    if (jitterTicks != 0) {
+        expiry += std::uniform_int_distribution<uint64_t>(0, jitterTicks)(random_);
+    }
+    job.base = base;
+    job.expiry = std::max(expiry, currentTick_ + 1);
+    job.generation++;
+    Place(Timer{static_cast<uint32_t>(index), job.generation, job.expiry});
+}
+
+void Scheduler::Place(const Timer& timer) {
+    // Level l holds deadlines less than 64^(l+1) ticks away, in the slot the
+    // level's index reaches when they are due; the top level also keeps
+    // anything further out and re-places it on each pass
+    const uint64_t delta = timer.expiry - currentTick_;
+    size_t level = 0;
+    while (level + 1 < kLevels && delta >= (uint64_t(1) << (kSlotBits * (level + 1)))) {
+        level++;
+    }
+    const uint64_t horizon = currentTick_ + (uint64_t(1) << (kSlotBits * kLevels)) - 1;
+    const uint64_t due = std::min(timer.expiry, horizon);
+    wheel_[level][(due >> (kSlotBits * level)) & (kSlots - 1)].push_back(timer);
+}
+
+void Scheduler::Advance(uint64_t tick) {
+    currentTick_ = tick;
+
+    // Pull the next stretch of each upper level down as the one below wraps
+    for (size_t level = 1; level < kLevels; ++level) {
+        if (tick & ((uint64_t(1) << (kSlotBits * level)) - 1)) {
+            break;
+        }
+        std::vector<Timer> pending;
+        pending.swap(wheel_[level][(tick >> (kSlotBits * level)) & (kSlots - 1)]);
+        for (const Timer& timer : pending) {
+            if (timer.generation == jobs_[timer.job].generation) {
+                Place(timer);
+            }
+        }
+    }
+
+    std::vector<Timer> due;
+    due.swap(wheel_[0][tick & (kSlots - 1)]);
+    for (const Timer& timer : due) {
+        if (timer.generation == jobs_[timer.job].generation) {
+            Fire(timer.job);
+        }
+    }
+}
+
+void Scheduler::Fire(size_t index) {
+    Job& job = jobs_[index];
+    if (job.queued || job.running) {
+        job.missedDeadlines++;
+    } else {
+        job.queued = true;
+        ready_.push_back(index);
+        workReady_.notify_one();
+    }
+    Arm(index, job.base + TicksFor(job.interval));
+}
+
+uint64_t Scheduler::NextExpiry() const {
+    uint64_t next = kNever;
+    for (const Job& job : jobs_) {
+        if (job.id != kInvalidJob) {
+            next = std::min(next, job.expiry);
+        }
+    }
+    return next;
+}
+
+void Scheduler::TimerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        // Catch up tick by tick after a late wakeup; deadlines that pile up
+        // behind a busy job are counted as missed, not run back to back
+        const uint64_t now = TickAt(Clock::now());
+        while (currentTick_ < now) {
+            Advance(currentTick_ + 1);
+        }
+
+        const uint64_t next = NextExpiry();
+        if (next == kNever) {
+            timerWake_.wait(lock);
+        } else {
+            timerWake_.wait_until(lock, epoch_ + config_.tick * next);
+        }
+    }
+}
+
+void Scheduler::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        workReady_.wait(lock, [this] { return stopping_ || !ready_.empty(); });
+        if (stopping_) {
+            return;
+        }
+        const size_t index = ready_.front();
+        ready_.pop_front();
+        if (jobs_[index].id == kInvalidJob) {
+            continue;
+        }
+        jobs_[index].queued = false;
+        jobs_[index].running = true;
+        Task task = jobs_[index].task;
+        lock.unlock();
+
+        const auto start = Clock::now();
+        bool failed = false;
+        try {
+            task();
+        }
+        catch (...) {
+            failed = true;
+        }
+        const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+
+        // jobs_ may have grown while the task ran; index again
+        lock.lock();
+        Job& job = jobs_[index];
+        job.running = false;
+        job.runs++;
+        if (failed) {
+            job.failures++;
+        }
+        job.lastDuration = duration;
+        job.maxDuration = std::max(job.maxDuration, duration);
+    }
+}
@@ -2,9 +2,13 @@
 #include "ViewManager.h"
 #include "GeminiClient.h"
 #include "SecurityMonitor.h"
+#include "NetworkMonitor.h"
+#include "SignatureEngine.h"
+#include "DnsResolver.h"
 #include "Utils.h"
 #include <iostream>
 #include <memory>
+#include <algorithm>
 
 SecurityApp::SecurityApp() 
     : isRunning_(false) {
@@ -128,11 +132,83 @@ void SecurityApp::InitializeComponents() {
 
     // Initialize security monitor
     securityMonitor_ = std::make_unique<SecurityMonitor>();
+    ConfigureThreatIntel(securityMonitor_->GetNetworkMonitor());
+    ConfigureSignatures(securityMonitor_->GetNetworkMonitor());
+    ConfigureDns();
+    ConfigureChecks(*securityMonitor_);
     
     // Initialize view manager
     viewManager_ = std::make_unique<ViewManager>(this);
 }
 
+void SecurityApp::ConfigureThreatIntel(NetworkMonitor& monitor) {
+    auto& config = Utils::Config::Instance();
+
+    // feeds: comma-separated feed files or directories of them
+    std::vector<std::string> feeds;
+    for (const auto& feed : Utils::Split(config.GetString("threat_intel", "feeds", "threat_feeds"), ',')) {
+        std::string path = Utils::Trim(feed);
+        if (!path.empty()) {
+            feeds.push_back(path);
+        }
+    }
+    monitor.SetThreatIntelSources(feeds, config.GetString("threat_intel", "database", "threat_intel.db"));
+}
+
+void SecurityApp::ConfigureSignatures(NetworkMonitor& monitor) {
+    // file: "name:hexbytes" lines; no file leaves payload scanning off
+    std::string path = Utils::Config::Instance().GetString("signatures", "file", "signatures.txt");
+    if (!Utils::FileExists(path)) {
+        return;
+    }
+
+    auto engine = std::make_shared<SignatureEngine>();
+    size_t rejected = 0;
+    if (!engine->LoadFile(path, &rejected) || !engine->Compile()) {
+        std::cerr << "Signatures not loaded: " << engine->GetError() << std::endl;
+        return;
+    }
+    if (rejected) {
+        std::cerr << "Signatures: skipped " << rejected << " malformed lines in " << path << std::endl;
+    }
+    monitor.SetSignatureEngine(std::move(engine));
+}
+
+void SecurityApp::ConfigureDns() {
+    auto& config = Utils::Config::Instance();
+    DnsResolver::Config settings;
+    settings.workers = static_cast<size_t>(std::max(1, config.GetInt("dns", "workers", 4)));
+    settings.cacheCapacity = static_cast<size_t>(std::max(16, config.GetInt("dns", "cache_size", 65536)));
+    settings.positiveTtl = std::chrono::seconds(std::max(0, config.GetInt("dns", "positive_ttl", 3600)));
+    settings.negativeTtl = std::chrono::seconds(std::max(0, config.GetInt("dns", "negative_ttl", 300)));
+
+    // hosts_file: answer from a hosts-format file only; enabled=false: no lookups at all
+    DnsResolver::LookupFunction lookup = DnsResolver::SystemLookup;
+    const std::string hostsFile = config.GetString("dns", "hosts_file", "");
+    if (!config.GetBool("dns", "enabled", true)) {
+        lookup = [](const IPAddress&, std::string&) { return false; };
+    } else if (!hostsFile.empty()) {
+        lookup = DnsResolver::HostsFileLookup(hostsFile);
+        if (!lookup) {
+            std::cerr << "DNS hosts file not readable: " << hostsFile << std::endl;
+            lookup = DnsResolver::SystemLookup;
+        }
+    }
+    DnsResolver::SetGlobal(std::make_shared<DnsResolver>(settings, std::move(lookup)));
+}
+
+void SecurityApp::ConfigureChecks(SecurityMonitor& monitor) {
+    auto& config = Utils::Config::Instance();
+
+    // update_interval (seconds) applies to every check unless <check>_interval overrides it
+    const int interval = std::max(1, config.GetInt("monitoring", "update_interval", 5));
+    const auto jitter = std::chrono::milliseconds(std::max(0, config.GetInt("monitoring", "jitter_ms", 250)));
+    for (const char* check : {"processes", "network", "resources", "filesystem"}) {
+        const int seconds = std::max(1, config.GetInt("monitoring", std::string(check) + "_interval", interval));
+        monitor.SetCheckInterval(check, std::chrono::seconds(seconds), jitter);
+    }
+}
+
 void SecurityApp::SetupEventHandlers() {
     // Setup security event handler
     if (securityMonitor_) {
@@ -1,4 +1,5 @@
 #include "SecurityMonitor.h"
+#include "NetworkMonitor.h"
 #include "Utils.h"
 #include <thread>
 #include <chrono>
@@ -14,7 +15,27 @@
 #pragma comment(lib, "iphlpapi.lib")
 #endif
 
-SecurityMonitor::SecurityMonitor() : isMonitoring_(false) {
+SecurityMonitor::SecurityMonitor(size_t eventCapacity)
+    : isMonitoring_(false), scheduler_(std::make_unique<Scheduler>()), events_(eventCapacity),
+      networkMonitor_(std::make_unique<NetworkMonitor>()),
+      processScans_(0), processesSpawned_(0), processesExited_(0) {
+    // Network detections (port scans, floods, SYN floods) surface as security events;
+    // block/unblock notices stay in the network log only
+    networkMonitor_->SetThreatCallback([this](const NetworkMonitor::NetworkLog& log) {
+        if (log.severity >= 3) {
+            AddEvent("NETWORK", "NetworkMonitor",
+                     log.threat + " (" + log.sourceIp.ToString() + " -> " + log.destinationIp.ToString() + ")",
+                     log.severity);
+        }
+    });
+
+    // Staggered by the jitter so the checks do not all land on one tick
+    const auto interval = std::chrono::seconds(5);
+    const auto jitter = std::chrono::milliseconds(250);
+    AddCheck("processes", interval, jitter, [this] { CheckProcesses(); });
+    AddCheck("network", interval, jitter, [this] { CheckNetworkActivity(); });
+    AddCheck("resources", interval, jitter, [this] { CheckSystemResources(); });
+    AddCheck("filesystem", interval, jitter, [this] { CheckFileSystem(); });
 }
 
 SecurityMonitor::~SecurityMonitor() {
@@ -27,7 +48,8 @@ bool SecurityMonitor::StartMonitoring() {
     }
     
     isMonitoring_.store(true);
-    monitoringThread_ = std::thread(&SecurityMonitor::MonitoringLoop, this);
+    networkMonitor_->StartMonitoring();
+    scheduler_->Start();
     
     AddEvent("SYSTEM", "SecurityMonitor", "Security monitoring started", 1);
     return true;
@@ -40,69 +62,98 @@ void SecurityMonitor::StopMonitoring() {
     
     isMonitoring_.store(false);
     
-    if (monitoringThread_.joinable()) {
-        monitoringThread_.join();
-    }
+    // Returns as soon as the checks already running finish
+    scheduler_->Stop();
+    networkMonitor_->StopMonitoring();
     
     AddEvent("SYSTEM", "SecurityMonitor", "Security monitoring stopped", 1);
 }
 
+bool SecurityMonitor::AddCheck(const std::string& name, std::chrono::milliseconds interval,
+                               std::chrono::milliseconds jitter, std::function<void()> check) {
+    std::lock_guard<std::mutex> lock(checksMutex_);
+    for (const auto& entry : checks_) {
+        if (entry.first == name) {
+            return false;
+        }
+    }
+
+    auto task = [this, name, check = std::move(check)] {
+        try {
+            check();
+        }
+        catch (const std::exception& e) {
+            AddEvent("ERROR", "SecurityMonitor", "Monitoring error in " + name + ": " + e.what(), 3);
+            throw;  // counted as a failure in the check's stats
+        }
+    };
+    Scheduler::JobId id = scheduler_->AddJob(name, interval, jitter, std::move(task));
+    if (id == Scheduler::kInvalidJob) {
+        return false;
+    }
+    checks_.emplace_back(name, id);
+    return true;
+}
+
+bool SecurityMonitor::SetCheckInterval(const std::string& name, std::chrono::milliseconds interval,
+                                       std::chrono::milliseconds jitter) {
+    std::lock_guard<std::mutex> lock(checksMutex_);
+    for (const auto& entry : checks_) {
+        if (entry.first == name) {
+            return scheduler_->SetInterval(entry.second, interval, jitter);
+        }
+    }
+    return false;
+}
+
 void SecurityMonitor::SetEventCallback(EventCallback callback) {
     eventCallback_ = callback;
 }
 
 std::vector<SecurityMonitor::SecurityEvent> SecurityMonitor::GetRecentEvents(int limit) const {
-    std::lock_guard<std::mutex> lock(eventsMutex_);
-    
-    std::vector<SecurityEvent> result;
-    int count = std::min<int>(limit, static_cast<int>(events_.size()));
-    
-    if (count > 0) {
-        result.assign(events_.end() - count, events_.end());
+    if (limit <= 0) {
+        return {};
     }
-    
-    return result;
+    return events_.Snapshot(static_cast<size_t>(limit));
 }
 
 void SecurityMonitor::ClearEvents() {
-    std::lock_guard<std::mutex> lock(eventsMutex_);
-    events_.clear();
+    events_.Clear();
 }
 
 SecurityMonitor::SystemMetrics SecurityMonitor::GetCurrentMetrics() const {
     SystemMetrics metrics;
     metrics.cpuUsage = Utils::GetCPUUsage();
     metrics.memoryUsage = Utils::GetMemoryUsage();
-    metrics.activeConnections = 0; // Would be populated from network monitoring
-    metrics.suspiciousActivity = 0; // Would be calculated from events
+    metrics.activeConnections = static_cast<int>(networkMonitor_->GetConnectionCount());
+    metrics.suspiciousActivity = networkMonitor_->GetThreatCount();
     metrics.lastUpdate = std::chrono::system_clock::now();
-    
-    // Simulate some realistic values for demo
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_real_distribution<> dis(0.0, 10.0);
-    
-    metrics.activeConnections = 15 + static_cast<int>(dis(gen));
-    metrics.suspiciousActivity = static_cast<int>(dis(gen) / 5);
-    
     return metrics;
 }
 
 std::vector<SecurityMonitor::SystemMetrics> SecurityMonitor::GetMetricsHistory(int minutes) const {
-    std::lock_guard<std::mutex> lock(metricsMutex_);
-    
-    auto cutoff = std::chrono::system_clock::now() - std::chrono::minutes(minutes);
+    std::vector<MetricsSeries::Point> points = GetMetricsSeries(minutes);
+
     std::vector<SystemMetrics> result;
-    
-    for (const auto& metrics : metricsHistory_) {
-        if (metrics.lastUpdate >= cutoff) {
-            result.push_back(metrics);
-        }
+    result.reserve(points.size());
+    for (const auto& point : points) {
+        SystemMetrics metrics;
+        metrics.cpuUsage = point.Mean(FieldCpuUsage);
+        metrics.memoryUsage = point.Mean(FieldMemoryUsage);
+        metrics.activeConnections = static_cast<int>(point.Mean(FieldActiveConnections));
+        metrics.suspiciousActivity = static_cast<int>(point.Mean(FieldSuspiciousActivity));
+        metrics.lastUpdate = point.start;
+        result.push_back(metrics);
     }
-    
     return result;
 }
 
+std::vector<SecurityMonitor::MetricsSeries::Point> SecurityMonitor::GetMetricsSeries(int minutes) const {
+    auto now = std::chrono::system_clock::now();
+    std::lock_guard<std::mutex> lock(metricsMutex_);
+    return metricsHistory_.Query(now - std::chrono::minutes(minutes), now);
+}
+
 int SecurityMonitor::GetThreatLevel() const {
     // Calculate threat level based on recent events and metrics
     auto recentEvents = GetRecentEvents(50);
@@ -135,47 +186,24 @@ std::string SecurityMonitor::GetThreatSummary() const {
     }
 }
 
-void SecurityMonitor::MonitoringLoop() {
-    while (isMonitoring_.load()) {
-        try {
-            CheckProcesses();
-            CheckNetworkActivity();
-            CheckSystemResources();
-            CheckFileSystem();
-            
-            // Store current metrics
-            auto metrics = GetCurrentMetrics();
-            {
-                std::lock_guard<std::mutex> lock(metricsMutex_);
-                metricsHistory_.push_back(metrics);
-                
-                // Keep only last hour of data
-                auto cutoff = std::chrono::system_clock::now() - std::chrono::hours(1);
-                metricsHistory_.erase(
-                    std::remove_if(metricsHistory_.begin(), metricsHistory_.end(),
-                                  [cutoff](const SystemMetrics& m) { return m.lastUpdate < cutoff; }),
-                    metricsHistory_.end()
-                );
-            }
-        }
-        catch (const std::exception& e) {
-            AddEvent("ERROR", "SecurityMonitor", "Monitoring error: " + std::string(e.what()), 3);
-        }
-        
-        // Check every 5 seconds
-        std::this_thread::sleep_for(std::chrono::seconds(5));
-    }
-}
-
 void SecurityMonitor::CheckProcesses() {
     CollectProcessInfo();
     
-    // Simulate process monitoring
     static int checkCount = 0;
     checkCount++;
     
-    if (checkCount % 12 == 0) { // Every minute
-        AddEvent("PROCESS", "ProcessMonitor", "Routine process scan completed", 1);
+    if (checkCount % 12 == 0) { // Every minute at the default interval
+        size_t count;
+        {
+            std::lock_guard<std::mutex> lock(processMutex_);
+            count = processTable_.Size();
+        }
+        AddEvent("PROCESS", "ProcessMonitor",
+                 "Routine process scan completed: " + std::to_string(count) + " processes, " +
+                 std::to_string(processesSpawned_) + " started and " + std::to_string(processesExited_) +
+                 " exited since the last report", 1);
+        processesSpawned_ = 0;
+        processesExited_ = 0;
     }
 }
 
@@ -196,6 +224,16 @@ void SecurityMonitor::CheckSystemResources() {
     CollectSystemInfo();
     
     auto metrics = GetCurrentMetrics();
+    {
+        // Rollup tiers age out old data on their own
+        std::lock_guard<std::mutex> lock(metricsMutex_);
+        metricsHistory_.Record(metrics.lastUpdate, {
+            metrics.cpuUsage,
+            metrics.memoryUsage,
+            static_cast<double>(metrics.activeConnections),
+            static_cast<double>(metrics.suspiciousActivity)
+        });
+    }
     
     if (metrics.cpuUsage > 90.0) {
         AddEvent("SYSTEM", "ResourceMonitor", "High CPU usage detected", 3);
@@ -211,7 +249,7 @@ void SecurityMonitor::CheckFileSystem() {
     static int fsCheckCount = 0;
     fsCheckCount++;
     
-    if (fsCheckCount % 24 == 0) { // Every 2 minutes
+    if (fsCheckCount % 24 == 0) { // Every 2 minutes at the default interval
         AddEvent("FILESYSTEM", "FileSystemMonitor", "File system integrity check completed", 1);
     }
 }
@@ -220,9 +258,33 @@ void SecurityMonitor::CollectProcessInfo() {
 #ifdef _WIN32
     // Implementation for Windows process monitoring
     // This would use EnumProcesses, OpenProcess, etc.
+#else
+    processChanges_.clear();
+    {
+        std::lock_guard<std::mutex> lock(processMutex_);
+        if (!processTable_.Scan(processChanges_)) {
+            return;
+        }
+    }
+    // The first scan lists everything already running; only later ones are news
+    if (processScans_++ == 0) {
+        return;
+    }
+    for (const auto& change : processChanges_) {
+        if (change.type == LinuxProcessTable::Change::Type::Spawned) {
+            processesSpawned_++;
+        } else if (change.type == LinuxProcessTable::Change::Type::Exited) {
+            processesExited_++;
+        }
+    }
 #endif
 }
 
+std::vector<LinuxProcessTable::Process> SecurityMonitor::GetProcesses() const {
+    std::lock_guard<std::mutex> lock(processMutex_);
+    return processTable_.GetProcesses();
+}
+
 void SecurityMonitor::CollectNetworkInfo() {
 #ifdef _WIN32
     // Implementation for Windows network monitoring
@@ -246,15 +308,8 @@ void SecurityMonitor::AddEvent(const std::string& type, const std::string& sourc
     event.description = description;
     event.severity = severity;
     
-    {
-        std::lock_guard<std::mutex> lock(eventsMutex_);
-        events_.push_back(event);
-        
-        // Keep only last 1000 events
-        if (events_.size() > 1000) {
-            events_.erase(events_.begin(), events_.begin() + 100);
-        }
-    }
+    // The ring overwrites the oldest event once it is full
+    events_.Push(event);
     
     // Notify callback
     if (eventCallback_) {
@@ -0,0 +1,633 @@
+#include "SignatureEngine.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <numeric>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define SENTINEL_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define SENTINEL_TARGET_AVX2
+#else
+#define SENTINEL_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+
+// Positions per candidate bitmap; the automaton walks one block at a time
+constexpr size_t kBlockSize = 16384;
+constexpr size_t kBlockWords = kBlockSize / 64;
+
+// States with this many children get a complete 256-entry row
+constexpr size_t kDenseFanout = 16;
+
+// ~1% of probes pass at 10 bits per gram, before rounding to a power of two
+constexpr size_t kFilterBitsPerGram = 10;
+constexpr uint32_t kMinFilterBits = 6;   // log2 of the word count
+constexpr uint32_t kMaxFilterBits = 22;  // 32 MB
+
+// 32-bit odd multiplier; the 64-bit product gives the word index from its
+// low half and both bit positions from its high half
+constexpr uint64_t kGramMultiplier = 0x9E3779B1u;
+
+constexpr size_t kGramSize = 4;
+
+// Candidate starts are confirmed against the signatures' first 4-8 bytes
+constexpr size_t kMaxPrefixLength = 8;
+constexpr size_t kPrefixBitsPerSignature = 24;
+
+struct FilterView {
+    const uint64_t* words;
+    uint32_t shift;  // word index = low 32 bits of the product >> shift
+    uint32_t mask;
+    size_t stride;
+    const uint64_t* prefixWords;
+    uint32_t prefixShift;
+    size_t prefixLength;
+    uint64_t prefixMask;  // keeps the first prefixLength bytes of an 8-byte load
+};
+
+struct CandidateBlock {
+    size_t begin;
+    size_t end;
+    uint64_t* bits;  // bit p - begin set when a signature may start at p
+};
+
+inline uint32_t LoadGram(const uint8_t* p) {
+    uint32_t gram;
+    std::memcpy(&gram, p, sizeof(gram));
+    return gram;
+}
+
+inline uint64_t Mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+inline unsigned TrailingZeros(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(value));
+#endif
+}
+
+inline int HexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+inline bool IsSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+std::string_view Trim(std::string_view text) {
+    while (!text.empty() && IsSpace(text.front())) text.remove_prefix(1);
+    while (!text.empty() && IsSpace(text.back())) text.remove_suffix(1);
+    return text;
+}
+
+inline bool ProbeGram(const FilterView& filter, uint32_t gram) {
+    const uint64_t h = gram * kGramMultiplier;
+    const uint64_t word = filter.words[static_cast<uint32_t>(h) >> filter.shift];
+    return ((word >> ((h >> 32) & 63)) & (word >> ((h >> 38) & 63)) & (word >> ((h >> 44) & 63)) & 1) != 0;
+}
+
+inline uint64_t PrefixHash(uint64_t prefix) {
+    return Mix64(prefix ^ 0x2545F4914F6CDD1Dull);
+}
+
+inline bool ProbePrefix(const FilterView& filter, const uint8_t* data, size_t length, size_t position) {
+    uint64_t prefix = 0;
+    if (position + sizeof(prefix) <= length) {
+        std::memcpy(&prefix, data + position, sizeof(prefix));
+        prefix &= filter.prefixMask;
+    } else if (position + filter.prefixLength <= length) {
+        std::memcpy(&prefix, data + position, filter.prefixLength);
+    } else {
+        return true;  // undecided until the next buffer
+    }
+    const uint64_t h = PrefixHash(prefix);
+    const uint64_t word = filter.prefixWords[h >> filter.prefixShift];
+    return ((word >> (h & 63)) & (word >> ((h >> 6) & 63)) & 1) != 0;
+}
+
+inline void MarkPosition(const CandidateBlock& block, size_t position) {
+    const size_t bit = position - block.begin;
+    block.bits[bit >> 6] |= 1ull << (bit & 63);
+}
+
+// A probe at q decides the positions (q - stride, q]: the one aligned probe
+// that lands inside the first `stride` bytes of a signature starting there.
+// Positions it passes are confirmed by their prefix before being marked.
+inline void MarkProbe(const FilterView& filter, const uint8_t* data, size_t length,
+                      const CandidateBlock& block, size_t probe) {
+    const size_t first = std::max(probe + 1 >= filter.stride ? probe + 1 - filter.stride : 0, block.begin);
+    const size_t last = std::min(probe, block.end - 1);
+    for (size_t p = first; p <= last; ++p) {
+        if (ProbePrefix(filter, data, length, p)) {
+            MarkPosition(block, p);
+        }
+    }
+}
+
+inline size_t NextCandidate(const CandidateBlock& block, size_t position) {
+    const size_t words = (block.end - block.begin + 63) / 64;
+    size_t bit = position - block.begin;
+    size_t index = bit >> 6;
+    uint64_t word = block.bits[index] & (~0ull << (bit & 63));
+    while (!word) {
+        if (++index == words) {
+            return block.end;
+        }
+        word = block.bits[index];
+    }
+    return block.begin + (index << 6) + TrailingZeros(word);
+}
+
+#ifdef SENTINEL_X86
+
+// Spreads a 4-bit mask onto the even bits of a byte
+constexpr uint8_t kSpreadEven[16] = {
+    0x00, 0x01, 0x04, 0x05, 0x10, 0x11, 0x14, 0x15,
+    0x40, 0x41, 0x44, 0x45, 0x50, 0x51, 0x54, 0x55,
+};
+
+SENTINEL_TARGET_AVX2 inline int TestAvx2(const FilterView& filter, __m256i hash, __m256i indexMask,
+                                         __m128i indexShift) {
+    const __m256i bitMask = _mm256_set1_epi64x(63);
+    const __m256i index = _mm256_and_si256(_mm256_srl_epi64(hash, indexShift), indexMask);
+    const __m256i words = _mm256_i64gather_epi64(reinterpret_cast<const long long*>(filter.words), index, 8);
+    const __m256i first = _mm256_and_si256(_mm256_srli_epi64(hash, 32), bitMask);
+    const __m256i second = _mm256_and_si256(_mm256_srli_epi64(hash, 38), bitMask);
+    const __m256i third = _mm256_and_si256(_mm256_srli_epi64(hash, 44), bitMask);
+    const __m256i all = _mm256_and_si256(_mm256_and_si256(_mm256_srlv_epi64(words, first), _mm256_srlv_epi64(words, second)),
+                                         _mm256_srlv_epi64(words, third));
+    return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_slli_epi64(all, 63)));
+}
+
+// Eight probes per iteration: two 16-byte loads, one shuffle lays out the
+// eight grams, two 32x32->64 multiplies hash them and two gathers fetch
+// their filter words. Sets bit k of `hits` when probe `first + k * stride`
+// passes and returns how many probes it evaluated, a multiple of eight.
+SENTINEL_TARGET_AVX2 size_t ProbeAvx2(const FilterView& filter, const uint8_t* data, size_t length,
+                                      size_t first, size_t count, uint64_t* hits) {
+    const size_t stride = filter.stride;
+    alignas(32) uint8_t layout[32];
+    for (size_t lane = 0; lane < 2; ++lane) {
+        for (size_t gram = 0; gram < 4; ++gram) {
+            for (size_t byte = 0; byte < kGramSize; ++byte) {
+                layout[lane * 16 + gram * 4 + byte] = static_cast<uint8_t>(gram * stride + byte);
+            }
+        }
+    }
+    const __m256i shuffle = _mm256_load_si256(reinterpret_cast<const __m256i*>(layout));
+    const __m256i multiplier = _mm256_set1_epi64x(static_cast<long long>(kGramMultiplier));
+    const __m256i indexMask = _mm256_set1_epi64x(filter.mask);
+    const __m128i indexShift = _mm_cvtsi32_si128(static_cast<int>(filter.shift));
+    uint8_t* hitBytes = reinterpret_cast<uint8_t*>(hits);  // x86 is little-endian
+
+    size_t k = 0;
+    for (const uint8_t* p = data + first; k + 8 <= count && p + 4 * stride + 16 <= data + length;
+         k += 8, p += 8 * stride) {
+        const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 4 * stride));
+        const __m256i grams = _mm256_shuffle_epi8(
+            _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1), shuffle);
+        const __m256i evenHash = _mm256_mul_epu32(grams, multiplier);
+        const __m256i oddHash = _mm256_mul_epu32(_mm256_srli_epi64(grams, 32), multiplier);
+        hitBytes[k >> 3] = static_cast<uint8_t>(kSpreadEven[TestAvx2(filter, evenHash, indexMask, indexShift)] |
+                                                (kSpreadEven[TestAvx2(filter, oddHash, indexMask, indexShift)] << 1));
+    }
+    return k;
+}
+
+#endif
+
+} // namespace
+
+SignatureEngine::SignatureEngine()
+    : filterShift_(32), filterMask_(0), stride_(1), prefixShift_(64), prefixLength_(kMinSignatureLength),
+      prefixMask_(0), prefilter_(Prefilter::Scalar), compiled_(false) {
+    SetPrefilter(Prefilter::Auto);
+}
+
+bool SignatureEngine::HasAvx2() {
+#if defined(SENTINEL_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool osSavesAvx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+    if (!osSavesAvx) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif defined(SENTINEL_X86)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#else
+    return false;
+#endif
+}
+
+void SignatureEngine::SetPrefilter(Prefilter prefilter) {
+    if (prefilter != Prefilter::Scalar && HasAvx2()) {
+        prefilter_ = Prefilter::Avx2;
+    } else {
+        prefilter_ = Prefilter::Scalar;
+    }
+}
+
+int SignatureEngine::AddSignature(const std::string& name, std::string_view bytes) {
+    if (compiled_) {
+        error_ = "Signatures cannot be added after Compile";
+        return -1;
+    }
+    if (bytes.size() < kMinSignatureLength || bytes.size() > kMaxSignatureLength) {
+        error_ = "Signature " + name + " must be " + std::to_string(kMinSignatureLength) + " to " +
+                 std::to_string(kMaxSignatureLength) + " bytes";
+        return -1;
+    }
+    // State ids are 32-bit and bounded by the total signature length
+    if (patterns_.size() + bytes.size() >= 0xFFFFFF00u) {
+        error_ = "Signature set too large";
+        return -1;
+    }
+
+    patternOffsets_.push_back(patterns_.size());
+    patterns_.append(bytes.data(), bytes.size());
+    lengths_.push_back(static_cast<uint32_t>(bytes.size()));
+    names_.push_back(name);
+    return static_cast<int>(names_.size() - 1);
+}
+
+int SignatureEngine::AddHexSignature(const std::string& name, std::string_view hex) {
+    std::string bytes;
+    bytes.reserve(hex.size() / 2);
+    int high = -1;
+    for (char c : hex) {
+        if (IsSpace(c)) {
+            continue;
+        }
+        const int value = HexValue(c);
+        if (value < 0) {
+            error_ = "Signature " + name + " is not valid hex";
+            return -1;
+        }
+        if (high < 0) {
+            high = value;
+        } else {
+            bytes.push_back(static_cast<char>((high << 4) | value));
+            high = -1;
+        }
+    }
+    if (high >= 0) {
+        error_ = "Signature " + name + " has an odd number of hex digits";
+        return -1;
+    }
+    return AddSignature(name, bytes);
+}
+
+bool SignatureEngine::LoadFile(const std::string& path, size_t* rejected) {
+    MappedFile file;
+    if (!file.Open(path, true)) {
+        error_ = file.GetError();
+        return false;
+    }
+
+    size_t skipped = 0;
+    std::string_view text(reinterpret_cast<const char*>(file.Data()), file.Size());
+    while (!text.empty()) {
+        const size_t newline = text.find('\n');
+        std::string_view line = Trim(text.substr(0, newline));
+        text.remove_prefix(newline == std::string_view::npos ? text.size() : newline + 1);
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+
+        const size_t colon = line.find(':');
+        if (colon == std::string_view::npos || colon == 0 ||
+            AddHexSignature(std::string(Trim(line.substr(0, colon))), line.substr(colon + 1)) < 0) {
+            if (compiled_) {
+                return false;
+            }
+            skipped++;
+        }
+    }
+
+    if (rejected) {
+        *rejected = skipped;
+    }
+    error_.clear();
+    return true;
+}
+
+bool SignatureEngine::Compile() {
+    if (compiled_) {
+        return true;
+    }
+    const size_t count = names_.size();
+    std::string_view all(patterns_);
+    auto bytesOf = [&](uint32_t id) { return all.substr(patternOffsets_[id], lengths_[id]); };
+
+    // Build the trie depth-first from the sorted signatures: each one shares
+    // the nodes of its common prefix with the previous one
+    std::vector<uint32_t> order(count);
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](uint32_t a, uint32_t b) { return bytesOf(a) < bytesOf(b); });
+
+    std::vector<uint32_t> parent(1, 0);
+    std::vector<uint8_t> label(1, 0);
+    std::vector<uint16_t> depth(1, 0);
+    std::vector<uint32_t> terminal(count);
+    std::vector<uint32_t> path(1, 0);
+    std::string_view previous;
+    for (uint32_t id : order) {
+        const std::string_view bytes = bytesOf(id);
+        size_t common = 0;
+        while (common < bytes.size() && common < previous.size() && bytes[common] == previous[common]) {
+            ++common;
+        }
+        path.resize(common + 1);
+        for (size_t d = common; d < bytes.size(); ++d) {
+            path.push_back(static_cast<uint32_t>(parent.size()));
+            parent.push_back(path[d]);
+            label.push_back(static_cast<uint8_t>(bytes[d]));
+            depth.push_back(static_cast<uint16_t>(d + 1));
+        }
+        terminal[id] = path[bytes.size()];
+        previous = bytes;
+    }
+
+    // Renumber breadth-first, keeping depth-first order within a level: the
+    // children of every node become consecutive states
+    const size_t nodes = parent.size();
+    std::vector<uint32_t> levelStart(kMaxSignatureLength + 2, 0);
+    for (size_t node = 0; node < nodes; ++node) {
+        levelStart[depth[node] + 1]++;
+    }
+    std::partial_sum(levelStart.begin(), levelStart.end(), levelStart.begin());
+    std::vector<uint32_t> renumber(nodes);
+    for (size_t node = 0; node < nodes; ++node) {
+        renumber[node] = levelStart[depth[node]]++;
+    }
+
+    states_.assign(nodes, State{0, 0, 0, 0, 0});
+    labels_.assign(nodes, 0);
+    for (size_t node = 1; node < nodes; ++node) {
+        const uint32_t state = renumber[node];
+        State& up = states_[renumber[parent[node]]];
+        if (up.childCount++ == 0) {
+            up.children = state;
+        }
+        states_[state].depth = depth[node];
+        labels_[state] = label[node];
+    }
+
+    // Failure links breadth-first; dense rows are completed through the
+    // failure chain so a dense state never needs one at scan time
+    rows_.clear();
+    for (uint32_t state = 0; state < nodes; ++state) {
+        State& current = states_[state];
+        const uint32_t first = current.children;
+        const uint32_t children = current.childCount;
+        for (uint32_t child = first; child < first + children; ++child) {
+            states_[child].fail = state == 0 ? 0 : Step(current.fail, labels_[child]);
+        }
+        if (state == 0 || children >= kDenseFanout) {
+            const size_t row = rows_.size();
+            rows_.resize(row + 256);
+            for (size_t byte = 0; byte < 256; ++byte) {
+                rows_[row + byte] = state == 0 ? 0 : Step(current.fail, static_cast<uint8_t>(byte));
+            }
+            for (uint32_t child = first; child < first + children; ++child) {
+                rows_[row + labels_[child]] = child;
+            }
+            current.children = static_cast<uint32_t>(row / 256);
+            current.childCount = kDenseRow;
+        }
+    }
+
+    // Output chains: a state's own signatures, then those of its failure state
+    std::vector<std::pair<uint32_t, uint32_t>> ends(count);
+    for (uint32_t id = 0; id < count; ++id) {
+        ends[id] = {renumber[terminal[id]], id};
+    }
+    std::sort(ends.begin(), ends.end());
+    outputs_.assign(1, 0);
+    size_t next = 0;
+    for (uint32_t state = 1; state < nodes; ++state) {
+        const uint32_t inherited = states_[states_[state].fail].output;
+        if (next < ends.size() && ends[next].first == state) {
+            const size_t record = outputs_.size();
+            outputs_.push_back(inherited);
+            outputs_.push_back(0);
+            for (; next < ends.size() && ends[next].first == state; ++next) {
+                outputs_.push_back(ends[next].second);
+                outputs_[record + 1]++;
+            }
+            states_[state].output = static_cast<uint32_t>(record);
+        } else {
+            states_[state].output = inherited;
+        }
+    }
+
+    BuildFilter();
+
+    std::string().swap(patterns_);
+    std::vector<uint64_t>().swap(patternOffsets_);
+    compiled_ = true;
+    error_.clear();
+    return true;
+}
+
+void SignatureEngine::BuildFilter() {
+    // Signatures are at least stride + 3 bytes, so every gram offset fits
+    size_t shortest = kMaxSignatureLength;
+    for (uint32_t length : lengths_) {
+        shortest = std::min<size_t>(shortest, length);
+    }
+    stride_ = std::min<size_t>(4, shortest - (kGramSize - 1));
+
+    const size_t grams = std::max<size_t>(lengths_.size() * stride_, 1);
+    uint32_t bits = kMinFilterBits;
+    while (bits < kMaxFilterBits && (size_t(64) << bits) < grams * kFilterBitsPerGram) {
+        ++bits;
+    }
+    filter_.assign(size_t(1) << bits, 0);
+    filterShift_ = 32 - bits;
+    filterMask_ = (1u << bits) - 1;
+
+    // Second stage: the first prefixLength_ bytes of every signature
+    prefixLength_ = std::min(kMaxPrefixLength, shortest);
+    prefixMask_ = 0;
+    std::memset(&prefixMask_, 0xFF, prefixLength_);
+    uint32_t prefixBits = kMinFilterBits;
+    while (prefixBits < kMaxFilterBits &&
+           (size_t(64) << prefixBits) < lengths_.size() * kPrefixBitsPerSignature) {
+        ++prefixBits;
+    }
+    prefixFilter_.assign(size_t(1) << prefixBits, 0);
+    prefixShift_ = 64 - prefixBits;
+
+    for (uint32_t id = 0; id < lengths_.size(); ++id) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(patterns_.data()) + patternOffsets_[id];
+        for (size_t offset = 0; offset < stride_; ++offset) {
+            const uint64_t h = LoadGram(bytes + offset) * kGramMultiplier;
+            filter_[static_cast<uint32_t>(h) >> filterShift_] |=
+                (1ull << ((h >> 32) & 63)) | (1ull << ((h >> 38) & 63)) | (1ull << ((h >> 44) & 63));
+        }
+        uint64_t prefix = 0;
+        std::memcpy(&prefix, bytes, prefixLength_);
+        const uint64_t h = PrefixHash(prefix);
+        prefixFilter_[h >> prefixShift_] |= (1ull << (h & 63)) | (1ull << ((h >> 6) & 63));
+    }
+}
+
+inline uint32_t SignatureEngine::Step(uint32_t state, uint8_t byte) const {
+    for (;;) {
+        const State& current = states_[state];
+        if (current.childCount == kDenseRow) {
+            return rows_[static_cast<size_t>(current.children) * 256 + byte];
+        }
+        const uint8_t* labels = labels_.data() + current.children;
+        for (uint32_t i = 0; i < current.childCount; ++i) {
+            if (labels[i] == byte) {
+                return current.children + i;
+            }
+            if (labels[i] > byte) {
+                break;
+            }
+        }
+        state = current.fail;
+    }
+}
+
+void SignatureEngine::Report(uint32_t state, uint64_t end, const MatchCallback& onMatch) const {
+    for (uint32_t record = states_[state].output; record; record = outputs_[record]) {
+        const uint32_t matches = outputs_[record + 1];
+        for (uint32_t i = 0; i < matches; ++i) {
+            onMatch(Match{outputs_[record + 2 + i], end});
+        }
+    }
+}
+
+void SignatureEngine::MarkCandidates(const uint8_t* data, size_t length, size_t begin, size_t end,
+                                     uint64_t* bits) const {
+    const CandidateBlock block{begin, end, bits};
+    std::fill(bits, bits + (end - begin + 63) / 64, 0ull);
+
+    const FilterView filter{filter_.data(), filterShift_, filterMask_, stride_,
+                            prefixFilter_.data(), prefixShift_, prefixLength_, prefixMask_};
+    const size_t stride = stride_;
+    const size_t first = (begin + stride - 1) / stride * stride;
+    const size_t count = ((end - 1 + stride - 1) / stride * stride - first) / stride + 1;
+
+    // Probe first, marking which passed; branching on every probe costs more
+    // than the rare hits it would skip
+    uint64_t hits[kBlockWords + 1];
+    std::fill(hits, hits + (count + 63) / 64, 0ull);
+    size_t k = 0;
+#ifdef SENTINEL_X86
+    if (prefilter_ == Prefilter::Avx2) {
+        k = ProbeAvx2(filter, data, length, first, count, hits);
+    }
+#endif
+    const size_t decided = length < first + kGramSize ? k :
+                           std::max(k, std::min(count, (length - first - kGramSize) / stride + 1));
+    while (k < decided) {
+        const size_t word = k >> 6;
+        const size_t stop = std::min(decided, (word + 1) * 64);
+        uint64_t passed = 0;
+        for (; k < stop; ++k) {
+            passed |= static_cast<uint64_t>(ProbeGram(filter, LoadGram(data + first + k * stride))) << (k & 63);
+        }
+        hits[word] |= passed;
+    }
+
+    for (size_t word = 0; word < (decided + 63) / 64; ++word) {
+        for (uint64_t pending = hits[word]; pending; pending &= pending - 1) {
+            MarkProbe(filter, data, length, block, first + (word * 64 + TrailingZeros(pending)) * stride);
+        }
+    }
+    // Grams running past the buffer are undecided until the next one arrives
+    for (; k < count; ++k) {
+        const size_t probe = first + k * stride;
+        const size_t last = std::min(probe, end - 1);
+        for (size_t p = std::max(probe + 1 >= stride ? probe + 1 - stride : 0, begin); p <= last; ++p) {
+            MarkPosition(block, p);
+        }
+    }
+}
+
+void SignatureEngine::Scan(Stream& stream, const uint8_t* data, size_t length, const MatchCallback& onMatch) const {
+    if (!compiled_ || states_.size() <= 1) {
+        stream.offset += length;
+        return;
+    }
+
+    uint64_t bits[kBlockWords];
+    uint32_t state = stream.state < states_.size() ? stream.state : 0;
+    // Latest candidate start the automaton has consumed. The last bytes of a
+    // buffer are always candidates, so for a continuing stream that is the
+    // byte just before this buffer.
+    int64_t lastCandidate = -1;
+
+    for (size_t begin = 0; begin < length; begin += kBlockSize) {
+        const size_t end = std::min(length, begin + kBlockSize);
+        MarkCandidates(data, length, begin, end, bits);
+        const CandidateBlock block{begin, end, bits};
+
+        size_t i = begin;
+        while (i < end) {
+            // No candidate start inside the partial match: nothing in flight
+            // can complete, so restart at the next candidate
+            if (lastCandidate + states_[state].depth < static_cast<int64_t>(i)) {
+                state = 0;
+                i = NextCandidate(block, i);
+                if (i == end) {
+                    break;
+                }
+            }
+            const size_t bit = i - begin;
+            if ((bits[bit >> 6] >> (bit & 63)) & 1) {
+                lastCandidate = static_cast<int64_t>(i);
+            }
+            state = Step(state, data[i]);
+            ++i;
+            if (states_[state].output) {
+                Report(state, stream.offset + i, onMatch);
+            }
+        }
+    }
+
+    stream.state = state;
+    stream.offset += length;
+}
+
+size_t SignatureEngine::GetMemoryUsage() const {
+    size_t names = 0;
+    for (const auto& name : names_) {
+        names += name.capacity() + sizeof(std::string);
+    }
+    return names + lengths_.capacity() * sizeof(uint32_t) + patterns_.capacity() +
+           patternOffsets_.capacity() * sizeof(uint64_t) + states_.capacity() * sizeof(State) +
+           labels_.capacity() + rows_.capacity() * sizeof(uint32_t) + outputs_.capacity() * sizeof(uint32_t) +
+           (filter_.capacity() + prefixFilter_.capacity()) * sizeof(uint64_t) + sizeof(*this);
+}
@@ -0,0 +1,145 @@
+#include "SynFloodDetector.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+SynFloodDetector::SynFloodDetector()
+    : SynFloodDetector(Config()) {
+}
+
+SynFloodDetector::SynFloodDetector(const Config& config)
+    : config_(config), generation_(0) {
+}
+
+void SynFloodDetector::BeginScan() {
+    generation_++;
+    touched_.clear();
+}
+
+IPAddress SynFloodDetector::SourcePrefix(const IPAddress& source) const {
+    if (source.IsIPv4()) {
+        const int length = std::max(0, std::min(32, config_.ipv4PrefixLength));
+        const uint32_t mask = length == 0 ? 0 : 0xFFFFFFFFu << (32 - length);
+        return IPAddress::FromIPv4(source.ToIPv4() & mask);
+    }
+
+    const int length = std::max(0, std::min(128, config_.ipv6PrefixLength));
+    uint8_t bytes[16];
+    std::memcpy(bytes, source.Bytes(), sizeof(bytes));
+    for (int bit = length; bit < 128; ++bit) {
+        bytes[bit / 8] &= static_cast<uint8_t>(~(0x80u >> (bit % 8)));
+    }
+    return IPAddress::FromIPv6Bytes(bytes);
+}
+
+void SynFloodDetector::AddHalfOpen(const IPAddress& listenerAddress, uint16_t listenerPort,
+                                   const IPAddress& source) {
+    auto& entry = *listeners_.try_emplace(ListenerKey{listenerAddress, listenerPort}).first;
+    Listener& listener = entry.second;
+    if (listener.generation != generation_) {
+        // First touch this scan: decay the baseline across any scans it sat out
+        if (listener.generation != 0 && generation_ - listener.generation > 1) {
+            listener.baseline *= std::pow(1.0 - config_.baselineWeight,
+                                          static_cast<double>(generation_ - listener.generation - 1));
+        }
+        listener.generation = generation_;
+        listener.count = 0;
+        listener.liveSources = 0;
+        touched_.push_back(&entry);
+    }
+    listener.count++;
+
+    SourceEntry& sourceEntry = listener.sources[SourcePrefix(source)];
+    if (sourceEntry.generation != generation_) {
+        sourceEntry.generation = generation_;
+        sourceEntry.count = 0;
+        listener.liveSources++;
+    }
+    sourceEntry.count++;
+}
+
+void SynFloodDetector::EndScan(std::vector<Alert>& alerts) {
+    for (auto* entry : touched_) {
+        Evaluate(entry->first, entry->second, alerts);
+    }
+    touched_.clear();
+
+    if (generation_ % std::max<uint32_t>(config_.staleScans, 1) == 0) {
+        Sweep();
+    }
+}
+
+void SynFloodDetector::Evaluate(const ListenerKey& key, Listener& listener, std::vector<Alert>& alerts) {
+    const double threshold = std::max(static_cast<double>(config_.minHalfOpen),
+                                      listener.baseline * config_.baselineFactor);
+    const bool flooding = listener.count >= threshold;
+
+    if (!flooding) {
+        // Only quiet scans move the baseline, so a flood cannot teach itself to be normal
+        listener.baseline += config_.baselineWeight * (listener.count - listener.baseline);
+    } else {
+        const bool cooledDown = listener.lastAlertScan == 0 ||
+                                generation_ - listener.lastAlertScan >= config_.cooldownScans;
+        if (cooledDown || listener.count >= 2 * listener.lastAlertCount) {
+            Alert alert;
+            alert.listenerAddress = key.address;
+            alert.listenerPort = key.port;
+            alert.halfOpen = listener.count;
+            alert.baseline = listener.baseline;
+            alert.distinctSources = listener.liveSources;
+
+            std::vector<SourceCount> sources;
+            sources.reserve(listener.liveSources);
+            for (const auto& pair : listener.sources) {
+                if (pair.second.generation == generation_) {
+                    int length = pair.first.IsIPv4() ? config_.ipv4PrefixLength : config_.ipv6PrefixLength;
+                    sources.push_back(SourceCount{IPPrefixSet::Prefix{pair.first, length}, pair.second.count});
+                }
+            }
+            const size_t top = std::min(config_.topSources, sources.size());
+            std::partial_sort(sources.begin(), sources.begin() + top, sources.end(),
+                              [](const SourceCount& a, const SourceCount& b) { return a.halfOpen > b.halfOpen; });
+            sources.resize(top);
+            alert.topSources = std::move(sources);
+
+            alerts.push_back(std::move(alert));
+            listener.lastAlertScan = generation_;
+            listener.lastAlertCount = listener.count;
+        }
+    }
+
+    // Drop source prefixes from older scans once they dominate the map
+    if (listener.sources.size() > 2 * static_cast<size_t>(listener.liveSources) + 1024) {
+        for (auto it = listener.sources.begin(); it != listener.sources.end();) {
+            if (it->second.generation != generation_) {
+                it = listener.sources.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+void SynFloodDetector::Sweep() {
+    for (auto it = listeners_.begin(); it != listeners_.end();) {
+        if (generation_ - it->second.generation >= config_.staleScans) {
+            it = listeners_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+uint32_t SynFloodDetector::GetHalfOpen(const IPAddress& listenerAddress, uint16_t listenerPort) const {
+    auto it = listeners_.find(ListenerKey{listenerAddress, listenerPort});
+    if (it == listeners_.end() || it->second.generation != generation_) {
+        return 0;
+    }
+    return it->second.count;
+}
+
+void SynFloodDetector::Clear() {
+    listeners_.clear();
+    touched_.clear();
+    generation_ = 0;
+}
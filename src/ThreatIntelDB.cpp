@@ -0,0 +1,774 @@
+#include "ThreatIntelDB.h"
+#include "IPPrefixSet.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char kMagic[8] = {'S', 'S', 'T', 'I', 'N', 'T', 'E', 'L'};
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kByteOrderMark = 0x01020304;
+constexpr size_t kSectionAlignment = 64;
+
+// CIDR ranges enter the Bloom filter at the nearest coarser granularity
+constexpr int kV4Levels[] = {32, 24, 16, 8, 0};
+constexpr int kV6Levels[] = {128, 64, 56, 48, 32, 16, 0};
+
+constexpr size_t kDigestLengths[3] = {16, 20, 32};  // MD5, SHA-1, SHA-256
+
+// Split-block Bloom filter: 8 x 32-bit words per block, one bit set per word
+constexpr size_t kBloomWords = 8;
+constexpr double kBloomBitsPerKey = 12.0;  // ~0.5% false positives
+constexpr uint32_t kBloomSalt[kBloomWords] = {
+    0x47B6137Bu, 0x44974D91u, 0x8824AD5Bu, 0xA2B7289Du,
+    0x705495C7u, 0x2DF1424Bu, 0x9EFC4947u, 0x5C6BFB31u,
+};
+
+constexpr uint64_t kSeedV4 = 0x8A5CD789635D2DFFull;
+constexpr uint64_t kSeedV6 = 0x121FD2155C472F96ull;
+constexpr uint64_t kSeedDomain = 0x3C6EF372FE94F82Bull;
+constexpr uint64_t kSeedDigest = 0xA54FF53A5F1D36F1ull;
+
+enum Section : size_t {
+    SectionBloom,
+    SectionRangeBloom,
+    SectionFeedOffsets,
+    SectionFeedNames,
+    SectionV4,
+    SectionV6,
+    SectionDomains,
+    SectionDomainText,
+    SectionMd5,
+    SectionSha1,
+    SectionSha256,
+    SectionCount
+};
+
+struct SectionRef {
+    uint64_t offset;
+    uint64_t count;  // elements, not bytes
+};
+
+inline uint64_t Mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+uint64_t HashBytes(const char* data, size_t length, uint64_t seed) {
+    uint64_t h = seed ^ (length * 0x9E3779B97F4A7C15ull);
+    while (length >= 8) {
+        uint64_t word;
+        std::memcpy(&word, data, 8);
+        h = Mix64(h ^ word);
+        data += 8;
+        length -= 8;
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, data, length);
+    return Mix64(h ^ tail ^ 0xFF);
+}
+
+inline uint64_t LoadBigEndian64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v = (v << 8) | p[i];
+    return v;
+}
+
+inline uint32_t V4Mask(int length) {
+    return length == 0 ? 0 : 0xFFFFFFFFu << (32 - length);
+}
+
+inline void V6Mask(int length, uint64_t& hi, uint64_t& lo) {
+    hi = length >= 64 ? ~0ull : (length == 0 ? 0 : ~0ull << (64 - length));
+    lo = length <= 64 ? 0 : (length == 128 ? ~0ull : ~0ull << (128 - length));
+}
+
+inline uint64_t V4Key(uint32_t address, int level) {
+    return Mix64(((static_cast<uint64_t>(address & V4Mask(level)) << 8) | level) ^ kSeedV4);
+}
+
+inline uint64_t V6Key(uint64_t hi, uint64_t lo, int level) {
+    uint64_t maskHi, maskLo;
+    V6Mask(level, maskHi, maskLo);
+    return Mix64(Mix64((hi & maskHi) ^ kSeedV6) ^ (lo & maskLo) ^ static_cast<uint64_t>(level));
+}
+
+inline uint64_t DigestKey(const uint8_t* digest, size_t length) {
+    uint64_t word;
+    std::memcpy(&word, digest, 8);
+    return Mix64(word ^ kSeedDigest ^ length);
+}
+
+template <size_t N>
+int LevelIndex(const int (&levels)[N], int length) {
+    for (size_t i = 0; i < N; ++i) {
+        if (levels[i] <= length) return static_cast<int>(i);
+    }
+    return static_cast<int>(N) - 1;
+}
+
+inline bool LessV6(uint64_t aHi, uint64_t aLo, uint64_t bHi, uint64_t bLo) {
+    return aHi < bHi || (aHi == bHi && aLo < bLo);
+}
+
+inline bool BloomMayContain(const uint32_t* words, uint64_t blocks, uint64_t hash) {
+    const uint32_t* block = words + ((hash >> 32) * blocks >> 32) * kBloomWords;
+    const uint32_t low = static_cast<uint32_t>(hash);
+    uint32_t missing = 0;
+    for (size_t i = 0; i < kBloomWords; ++i) {
+        missing |= ~block[i] & (1u << ((low * kBloomSalt[i]) >> 27));
+    }
+    return missing == 0;
+}
+
+// Sized for ~0.5% false positives
+std::vector<uint32_t> BuildBloom(const std::vector<uint64_t>& keys) {
+    const uint64_t blocks = static_cast<uint64_t>(keys.size() * kBloomBitsPerKey / (kBloomWords * 32)) + 1;
+    std::vector<uint32_t> words(blocks * kBloomWords, 0);
+    for (uint64_t key : keys) {
+        uint32_t* block = &words[((key >> 32) * blocks >> 32) * kBloomWords];
+        const uint32_t low = static_cast<uint32_t>(key);
+        for (size_t i = 0; i < kBloomWords; ++i) {
+            block[i] |= 1u << ((low * kBloomSalt[i]) >> 27);
+        }
+    }
+    return words;
+}
+
+inline size_t AlignUp(size_t value) {
+    return (value + kSectionAlignment - 1) & ~(kSectionAlignment - 1);
+}
+
+inline int HexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Returns the digest kind (0-2) or -1 when `text` is not a hex MD5/SHA-1/SHA-256
+int ParseDigest(std::string_view text, uint8_t* out) {
+    int kind = -1;
+    for (int k = 0; k < 3; ++k) {
+        if (text.size() == kDigestLengths[k] * 2) kind = k;
+    }
+    if (kind < 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < text.size(); i += 2) {
+        const int high = HexValue(text[i]);
+        const int low = HexValue(text[i + 1]);
+        if (high < 0 || low < 0) return -1;
+        out[i / 2] = static_cast<uint8_t>((high << 4) | low);
+    }
+    return kind;
+}
+
+// Lower-cases and validates a host name, stripping URL, wildcard and
+// adblock decorations. `out` must hold 253 bytes.
+bool NormalizeDomain(std::string_view text, char* out, size_t& length) {
+    if (text.substr(0, 2) == "||") text.remove_prefix(2);
+    const size_t scheme = text.find("://");
+    if (scheme != std::string_view::npos) text.remove_prefix(scheme + 3);
+    const size_t end = text.find_first_of("/:^?#");
+    if (end != std::string_view::npos) text = text.substr(0, end);
+    if (text.substr(0, 2) == "*.") text.remove_prefix(2);
+    while (!text.empty() && text.front() == '.') text.remove_prefix(1);
+    while (!text.empty() && text.back() == '.') text.remove_suffix(1);
+
+    if (text.empty() || text.size() > 253) {
+        return false;
+    }
+    bool dot = false;
+    char previous = '.';
+    for (size_t i = 0; i < text.size(); ++i) {
+        char c = text[i];
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+        const bool valid = (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' || c == '_' || c == '.';
+        if (!valid || (c == '.' && previous == '.')) {
+            return false;
+        }
+        dot |= c == '.';
+        out[i] = previous = c;
+    }
+    length = text.size();
+    return dot;
+}
+
+inline bool IsSeparator(char c) {
+    return c == ' ' || c == '\t' || c == ',' || c == '\r';
+}
+
+template <size_t L>
+struct DigestRecord {
+    uint8_t digest[L];
+    uint16_t feed;
+
+    bool operator<(const DigestRecord& other) const { return std::memcmp(digest, other.digest, L) < 0; }
+    bool operator==(const DigestRecord& other) const { return std::memcmp(digest, other.digest, L) == 0; }
+};
+
+struct PendingDomain {
+    uint64_t hash;
+    uint64_t offset;  // into the parse-time text buffer
+    uint16_t length;
+    uint16_t feed;
+};
+
+std::vector<std::string> ListFeeds(const std::vector<std::string>& feedPaths) {
+    std::vector<std::string> files;
+    for (const std::string& path : feedPaths) {
+        std::error_code ec;
+        if (fs::is_directory(path, ec)) {
+            std::vector<std::string> entries;
+            for (const auto& entry : fs::directory_iterator(path, ec)) {
+                const std::string name = entry.path().filename().string();
+                if (!name.empty() && name[0] != '.' && entry.is_regular_file(ec)) {
+                    entries.push_back(entry.path().string());
+                }
+            }
+            std::sort(entries.begin(), entries.end());
+            files.insert(files.end(), entries.begin(), entries.end());
+        } else if (fs::is_regular_file(path, ec)) {
+            files.push_back(path);
+        }
+    }
+    return files;
+}
+
+} // namespace
+
+struct ThreatIntelDB::Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;     // files are host-endian; a foreign one is rejected and rebuilt
+    uint64_t fileSize;
+    uint64_t fingerprint;   // FeedFingerprint() of the sources
+    uint32_t feedCount;
+    uint32_t v4Levels;      // bit i: some range entered the filter at kV4Levels[i]
+    uint32_t v6Levels;
+    uint32_t reserved;
+    uint64_t bloomBlocks;
+    uint64_t rangeBloomBlocks;
+    SectionRef sections[SectionCount];
+};
+
+struct ThreatIntelDB::V4Range {
+    uint32_t first;
+    uint32_t last;
+    uint32_t feed;
+};
+
+struct ThreatIntelDB::V6Range {
+    uint64_t firstHi;
+    uint64_t firstLo;
+    uint64_t lastHi;
+    uint64_t lastLo;
+    uint32_t feed;
+    uint32_t reserved;
+};
+
+struct ThreatIntelDB::DomainRecord {
+    uint64_t hash;
+    uint32_t offset;  // into the domain text section
+    uint16_t length;
+    uint16_t feed;
+};
+
+ThreatIntelDB::ThreatIntelDB()
+    : header_(nullptr), bloom_(nullptr), bloomBlocks_(0), rangeBloom_(nullptr), rangeBloomBlocks_(0), v4_(nullptr), v6_(nullptr),
+      domains_(nullptr), domainText_(nullptr), digests_{nullptr, nullptr, nullptr},
+      feedOffsets_(nullptr), feedNames_(nullptr) {
+}
+
+uint64_t ThreatIntelDB::FeedFingerprint(const std::vector<std::string>& feedPaths) {
+    uint64_t h = Mix64(kVersion ^ kSeedDomain);
+    for (const std::string& file : ListFeeds(feedPaths)) {
+        std::error_code ec;
+        const uint64_t size = fs::file_size(file, ec);
+        const auto modified = fs::last_write_time(file, ec).time_since_epoch().count();
+        h = Mix64(h ^ HashBytes(file.data(), file.size(), kSeedV4));
+        h = Mix64(h ^ size);
+        h = Mix64(h ^ static_cast<uint64_t>(modified));
+    }
+    return h;
+}
+
+bool ThreatIntelDB::Compile(const std::vector<std::string>& feedPaths, const std::string& outputPath,
+                            CompileStats* stats, std::string& error) {
+    const auto start = std::chrono::steady_clock::now();
+    CompileStats local{};
+
+    const std::vector<std::string> files = ListFeeds(feedPaths);
+    if (files.empty()) {
+        error = "no threat feed files found";
+        return false;
+    }
+    if (files.size() > 0xFFFF) {
+        error = "too many threat feed files";
+        return false;
+    }
+
+    std::vector<V4Range> v4;
+    std::vector<V6Range> v6;
+    std::vector<PendingDomain> pending;
+    std::string pendingText;
+    std::vector<DigestRecord<16>> md5;
+    std::vector<DigestRecord<20>> sha1;
+    std::vector<DigestRecord<32>> sha256;
+    std::vector<uint64_t> bloomKeys;  // host addresses; the other tables add theirs after dedup
+    std::vector<uint64_t> rangeKeys;
+    uint32_t v4Levels = 0;
+    uint32_t v6Levels = 0;
+
+    std::vector<uint32_t> feedOffsets{0};
+    std::string feedNames;
+
+    for (size_t feedIndex = 0; feedIndex < files.size(); ++feedIndex) {
+        const uint16_t feed = static_cast<uint16_t>(feedIndex);
+        feedNames += fs::path(files[feedIndex]).filename().string();
+        feedOffsets.push_back(static_cast<uint32_t>(feedNames.size()));
+
+        MappedFile input;
+        if (!input.Open(files[feedIndex], true)) {
+            error = files[feedIndex] + ": " + input.GetError();
+            return false;
+        }
+        std::string_view text(reinterpret_cast<const char*>(input.Data()), input.Size());
+
+        while (!text.empty()) {
+            const size_t newline = text.find('\n');
+            std::string_view line = text.substr(0, newline);
+            text.remove_prefix(newline == std::string_view::npos ? text.size() : newline + 1);
+            local.lines++;
+
+            // First two fields; comments (#, !, ;) and blank lines are skipped
+            size_t pos = 0;
+            while (pos < line.size() && IsSeparator(line[pos])) ++pos;
+            if (pos == line.size() || line[pos] == '#' || line[pos] == '!' || line[pos] == ';') {
+                continue;
+            }
+            size_t tokenEnd = pos;
+            while (tokenEnd < line.size() && !IsSeparator(line[tokenEnd]) && line[tokenEnd] != '#') ++tokenEnd;
+            std::string_view token = line.substr(pos, tokenEnd - pos);
+            size_t nextPos = tokenEnd;
+            while (nextPos < line.size() && IsSeparator(line[nextPos])) ++nextPos;
+            size_t nextEnd = nextPos;
+            while (nextEnd < line.size() && !IsSeparator(line[nextEnd]) && line[nextEnd] != '#') ++nextEnd;
+            std::string_view second = line.substr(nextPos, nextEnd - nextPos);
+
+            // hosts-file lines ("0.0.0.0 bad.example") list the name, not the sink address
+            const bool hostsLine = !second.empty() &&
+                                   (token == "0.0.0.0" || token == "127.0.0.1" || token == "::" || token == "::1");
+            IPAddress address;
+            int length;
+            uint8_t digest[32];
+            int kind;
+            if (!hostsLine && IPPrefixSet::ParseCidr(token, address, length)) {
+                if (address.IsIPv4()) {
+                    const uint32_t first = address.ToIPv4() & V4Mask(length);
+                    v4.push_back(V4Range{first, first | ~V4Mask(length), feed});
+                    const int level = LevelIndex(kV4Levels, length);
+                    v4Levels |= 1u << level;
+                    (level == 0 ? bloomKeys : rangeKeys).push_back(V4Key(first, kV4Levels[level]));
+                } else {
+                    uint64_t maskHi, maskLo;
+                    V6Mask(length, maskHi, maskLo);
+                    const uint64_t hi = LoadBigEndian64(address.Bytes()) & maskHi;
+                    const uint64_t lo = LoadBigEndian64(address.Bytes() + 8) & maskLo;
+                    v6.push_back(V6Range{hi, lo, hi | ~maskHi, lo | ~maskLo, feed, 0});
+                    const int level = LevelIndex(kV6Levels, length);
+                    v6Levels |= 1u << level;
+                    (level == 0 ? bloomKeys : rangeKeys).push_back(V6Key(hi, lo, kV6Levels[level]));
+                }
+            } else if (!hostsLine && (kind = ParseDigest(token, digest)) >= 0) {
+                if (kind == 0) {
+                    md5.emplace_back();
+                    std::memcpy(md5.back().digest, digest, 16);
+                    md5.back().feed = feed;
+                } else if (kind == 1) {
+                    sha1.emplace_back();
+                    std::memcpy(sha1.back().digest, digest, 20);
+                    sha1.back().feed = feed;
+                } else {
+                    sha256.emplace_back();
+                    std::memcpy(sha256.back().digest, digest, 32);
+                    sha256.back().feed = feed;
+                }
+            } else {
+                char name[253];
+                size_t nameLength;
+                if (NormalizeDomain(hostsLine ? second : token, name, nameLength)) {
+                    pending.push_back(PendingDomain{HashBytes(name, nameLength, kSeedDomain), pendingText.size(),
+                                                    static_cast<uint16_t>(nameLength), feed});
+                    pendingText.append(name, nameLength);
+                } else {
+                    local.rejected++;
+                }
+            }
+        }
+    }
+
+    // Addresses: sort and merge overlapping ranges so a lookup is one binary search
+    std::sort(v4.begin(), v4.end(), [](const V4Range& a, const V4Range& b) {
+        return a.first < b.first || (a.first == b.first && a.last > b.last);
+    });
+    size_t kept = 0;
+    for (const V4Range& range : v4) {
+        if (kept && range.first <= v4[kept - 1].last) {
+            v4[kept - 1].last = std::max(v4[kept - 1].last, range.last);
+        } else {
+            v4[kept++] = range;
+        }
+    }
+    v4.resize(kept);
+
+    std::sort(v6.begin(), v6.end(), [](const V6Range& a, const V6Range& b) {
+        if (a.firstHi != b.firstHi || a.firstLo != b.firstLo) return LessV6(a.firstHi, a.firstLo, b.firstHi, b.firstLo);
+        return LessV6(b.lastHi, b.lastLo, a.lastHi, a.lastLo);
+    });
+    kept = 0;
+    for (const V6Range& range : v6) {
+        V6Range* back = kept ? &v6[kept - 1] : nullptr;
+        if (back && !LessV6(back->lastHi, back->lastLo, range.firstHi, range.firstLo)) {
+            if (LessV6(back->lastHi, back->lastLo, range.lastHi, range.lastLo)) {
+                back->lastHi = range.lastHi;
+                back->lastLo = range.lastLo;
+            }
+        } else {
+            v6[kept++] = range;
+        }
+    }
+    v6.resize(kept);
+
+    // Domains: order by hash, drop duplicates, and lay the text out in table order
+    auto pendingName = [&pendingText](const PendingDomain& d) {
+        return std::string_view(pendingText.data() + d.offset, d.length);
+    };
+    std::sort(pending.begin(), pending.end(), [&](const PendingDomain& a, const PendingDomain& b) {
+        return a.hash < b.hash || (a.hash == b.hash && pendingName(a) < pendingName(b));
+    });
+    std::vector<DomainRecord> domains;
+    std::string domainText;
+    domains.reserve(pending.size());
+    for (size_t i = 0; i < pending.size(); ++i) {
+        if (i && pending[i].hash == pending[i - 1].hash && pendingName(pending[i]) == pendingName(pending[i - 1])) {
+            continue;
+        }
+        if (domainText.size() + pending[i].length > 0xFFFFFFFFu) {
+            error = "domain table exceeds 4 GB";
+            return false;
+        }
+        domains.push_back(DomainRecord{pending[i].hash, static_cast<uint32_t>(domainText.size()),
+                                       pending[i].length, pending[i].feed});
+        domainText.append(pendingName(pending[i]));
+    }
+    std::vector<PendingDomain>().swap(pending);
+    std::string().swap(pendingText);
+
+    auto sortUnique = [](auto& records) {
+        std::stable_sort(records.begin(), records.end());
+        records.erase(std::unique(records.begin(), records.end()), records.end());
+    };
+    sortUnique(md5);
+    sortUnique(sha1);
+    sortUnique(sha256);
+
+    for (const DomainRecord& domain : domains) bloomKeys.push_back(domain.hash);
+    for (const auto& record : md5) bloomKeys.push_back(DigestKey(record.digest, 16));
+    for (const auto& record : sha1) bloomKeys.push_back(DigestKey(record.digest, 20));
+    for (const auto& record : sha256) bloomKeys.push_back(DigestKey(record.digest, 32));
+
+    const std::vector<uint32_t> bloom = BuildBloom(bloomKeys);
+    const std::vector<uint32_t> rangeBloom = BuildBloom(rangeKeys);
+    std::vector<uint64_t>().swap(bloomKeys);
+
+    // Lay out and write the file beside the target, then rename it into place
+    struct Blob {
+        const void* data;
+        uint64_t count;
+        size_t elementSize;
+    };
+    const Blob blobs[SectionCount] = {
+        {bloom.data(), bloom.size(), sizeof(uint32_t)},
+        {rangeBloom.data(), rangeBloom.size(), sizeof(uint32_t)},
+        {feedOffsets.data(), feedOffsets.size(), sizeof(uint32_t)},
+        {feedNames.data(), feedNames.size(), 1},
+        {v4.data(), v4.size(), sizeof(V4Range)},
+        {v6.data(), v6.size(), sizeof(V6Range)},
+        {domains.data(), domains.size(), sizeof(DomainRecord)},
+        {domainText.data(), domainText.size(), 1},
+        {md5.data(), md5.size(), sizeof(DigestRecord<16>)},
+        {sha1.data(), sha1.size(), sizeof(DigestRecord<20>)},
+        {sha256.data(), sha256.size(), sizeof(DigestRecord<32>)},
+    };
+
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byteOrder = kByteOrderMark;
+    header.fingerprint = FeedFingerprint(feedPaths);
+    header.feedCount = static_cast<uint32_t>(files.size());
+    header.v4Levels = v4Levels;
+    header.v6Levels = v6Levels;
+    header.bloomBlocks = bloom.size() / kBloomWords;
+    header.rangeBloomBlocks = rangeBloom.size() / kBloomWords;
+    size_t cursor = AlignUp(sizeof(Header));
+    for (size_t s = 0; s < SectionCount; ++s) {
+        header.sections[s] = SectionRef{cursor, blobs[s].count};
+        cursor = AlignUp(cursor + blobs[s].count * blobs[s].elementSize);
+    }
+    header.fileSize = cursor;
+
+    const std::string temporary = outputPath + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        const char padding[kSectionAlignment] = {};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        size_t written = sizeof(header);
+        for (size_t s = 0; s < SectionCount; ++s) {
+            out.write(padding, static_cast<std::streamsize>(header.sections[s].offset - written));
+            const size_t bytes = blobs[s].count * blobs[s].elementSize;
+            out.write(static_cast<const char*>(blobs[s].data), static_cast<std::streamsize>(bytes));
+            written = header.sections[s].offset + bytes;
+        }
+        out.write(padding, static_cast<std::streamsize>(header.fileSize - written));
+        out.close();
+        if (!out) {
+            error = "failed to write " + temporary;
+            std::error_code ec;
+            fs::remove(temporary, ec);
+            return false;
+        }
+    }
+    std::error_code ec;
+    fs::rename(temporary, outputPath, ec);
+    if (ec) {
+        error = "failed to replace " + outputPath + ": " + ec.message();
+        fs::remove(temporary, ec);
+        return false;
+    }
+
+    local.addressRanges = v4.size() + v6.size();
+    local.domains = domains.size();
+    local.fileHashes = md5.size() + sha1.size() + sha256.size();
+    local.fileSize = header.fileSize;
+    local.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    if (stats) {
+        *stats = local;
+    }
+    return true;
+}
+
+bool ThreatIntelDB::Open(const std::string& path) {
+    header_ = nullptr;
+    error_.clear();
+    if (!file_.Open(path)) {
+        error_ = file_.GetError();
+        return false;
+    }
+
+    const uint8_t* base = file_.Data();
+    const size_t size = file_.Size();
+    const Header* header = reinterpret_cast<const Header*>(base);
+    if (size < sizeof(Header) || std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0) {
+        error_ = "not a threat intelligence database";
+        return false;
+    }
+    if (header->version != kVersion || header->byteOrder != kByteOrderMark || header->fileSize != size) {
+        error_ = "incompatible or truncated threat intelligence database";
+        return false;
+    }
+
+    const size_t elementSizes[SectionCount] = {
+        sizeof(uint32_t), sizeof(uint32_t), sizeof(uint32_t), 1, sizeof(V4Range), sizeof(V6Range), sizeof(DomainRecord), 1,
+        sizeof(DigestRecord<16>), sizeof(DigestRecord<20>), sizeof(DigestRecord<32>),
+    };
+    for (size_t s = 0; s < SectionCount; ++s) {
+        const SectionRef& section = header->sections[s];
+        if (section.offset % kSectionAlignment != 0 || section.offset > size ||
+            section.count > (size - section.offset) / elementSizes[s]) {
+            error_ = "corrupt threat intelligence database";
+            return false;
+        }
+    }
+    if (header->bloomBlocks == 0 || header->sections[SectionBloom].count != header->bloomBlocks * kBloomWords ||
+        header->rangeBloomBlocks == 0 ||
+        header->sections[SectionRangeBloom].count != header->rangeBloomBlocks * kBloomWords ||
+        header->sections[SectionFeedOffsets].count != header->feedCount + 1ull) {
+        error_ = "corrupt threat intelligence database";
+        return false;
+    }
+
+    auto at = [&](Section s) { return base + header->sections[s].offset; };
+    bloom_ = reinterpret_cast<const uint32_t*>(at(SectionBloom));
+    bloomBlocks_ = header->bloomBlocks;
+    rangeBloom_ = reinterpret_cast<const uint32_t*>(at(SectionRangeBloom));
+    rangeBloomBlocks_ = header->rangeBloomBlocks;
+    feedOffsets_ = reinterpret_cast<const uint32_t*>(at(SectionFeedOffsets));
+    feedNames_ = reinterpret_cast<const char*>(at(SectionFeedNames));
+    v4_ = reinterpret_cast<const V4Range*>(at(SectionV4));
+    v6_ = reinterpret_cast<const V6Range*>(at(SectionV6));
+    domains_ = reinterpret_cast<const DomainRecord*>(at(SectionDomains));
+    domainText_ = reinterpret_cast<const char*>(at(SectionDomainText));
+    digests_[0] = at(SectionMd5);
+    digests_[1] = at(SectionSha1);
+    digests_[2] = at(SectionSha256);
+    header_ = header;
+    return true;
+}
+
+uint64_t ThreatIntelDB::GetFeedFingerprint() const {
+    return header_ ? header_->fingerprint : 0;
+}
+
+size_t ThreatIntelDB::GetIndicatorCount() const {
+    if (!header_) {
+        return 0;
+    }
+    const SectionRef* s = header_->sections;
+    return static_cast<size_t>(s[SectionV4].count + s[SectionV6].count + s[SectionDomains].count +
+                               s[SectionMd5].count + s[SectionSha1].count + s[SectionSha256].count);
+}
+
+size_t ThreatIntelDB::GetFeedCount() const {
+    return header_ ? header_->feedCount : 0;
+}
+
+void ThreatIntelDB::SetMatch(Match* match, IndicatorType type, uint32_t feed) const {
+    if (!match) {
+        return;
+    }
+    match->type = type;
+    match->feed = std::string_view();
+    if (feed < header_->feedCount) {
+        const uint32_t begin = feedOffsets_[feed];
+        const uint32_t end = feedOffsets_[feed + 1];
+        if (begin <= end && end <= header_->sections[SectionFeedNames].count) {
+            match->feed = std::string_view(feedNames_ + begin, end - begin);
+        }
+    }
+}
+
+bool ThreatIntelDB::LookupIP(const IPAddress& ip, Match* match) const {
+    if (!header_) {
+        return false;
+    }
+
+    if (ip.IsIPv4()) {
+        const uint32_t address = ip.ToIPv4();
+        bool candidate = (header_->v4Levels & 1u) && BloomMayContain(bloom_, bloomBlocks_, V4Key(address, 32));
+        for (size_t i = 1; i < sizeof(kV4Levels) / sizeof(kV4Levels[0]) && !candidate; ++i) {
+            candidate = (header_->v4Levels & (1u << i)) &&
+                        BloomMayContain(rangeBloom_, rangeBloomBlocks_, V4Key(address, kV4Levels[i]));
+        }
+        if (!candidate) {
+            return false;
+        }
+        const V4Range* end = v4_ + header_->sections[SectionV4].count;
+        const V4Range* it = std::upper_bound(v4_, end, address,
+                                             [](uint32_t value, const V4Range& range) { return value < range.first; });
+        if (it == v4_ || (it - 1)->last < address) {
+            return false;
+        }
+        SetMatch(match, IndicatorType::Address, (it - 1)->feed);
+        return true;
+    }
+
+    const uint64_t hi = LoadBigEndian64(ip.Bytes());
+    const uint64_t lo = LoadBigEndian64(ip.Bytes() + 8);
+    bool candidate = (header_->v6Levels & 1u) && BloomMayContain(bloom_, bloomBlocks_, V6Key(hi, lo, 128));
+    for (size_t i = 1; i < sizeof(kV6Levels) / sizeof(kV6Levels[0]) && !candidate; ++i) {
+        candidate = (header_->v6Levels & (1u << i)) &&
+                    BloomMayContain(rangeBloom_, rangeBloomBlocks_, V6Key(hi, lo, kV6Levels[i]));
+    }
+    if (!candidate) {
+        return false;
+    }
+    const V6Range* end = v6_ + header_->sections[SectionV6].count;
+    const V6Range* it = std::upper_bound(v6_, end, 0, [hi, lo](int, const V6Range& range) {
+        return LessV6(hi, lo, range.firstHi, range.firstLo);
+    });
+    if (it == v6_ || LessV6((it - 1)->lastHi, (it - 1)->lastLo, hi, lo)) {
+        return false;
+    }
+    SetMatch(match, IndicatorType::Address, (it - 1)->feed);
+    return true;
+}
+
+bool ThreatIntelDB::LookupDomain(std::string_view domain, Match* match) const {
+    char name[253];
+    size_t length;
+    if (!header_ || !NormalizeDomain(domain, name, length)) {
+        return false;
+    }
+
+    // Try the name, then each parent domain that still has a dot
+    const DomainRecord* end = domains_ + header_->sections[SectionDomains].count;
+    const uint64_t textSize = header_->sections[SectionDomainText].count;
+    for (size_t start = 0; start < length;) {
+        const std::string_view suffix(name + start, length - start);
+        const size_t dot = suffix.find('.');
+        if (dot == std::string_view::npos) {
+            break;
+        }
+
+        const uint64_t hash = HashBytes(suffix.data(), suffix.size(), kSeedDomain);
+        if (BloomMayContain(bloom_, bloomBlocks_, hash)) {
+            const DomainRecord* it = std::lower_bound(domains_, end, hash,
+                                                      [](const DomainRecord& record, uint64_t value) { return record.hash < value; });
+            for (; it != end && it->hash == hash; ++it) {
+                if (it->length == suffix.size() && static_cast<uint64_t>(it->offset) + it->length <= textSize &&
+                    std::memcmp(domainText_ + it->offset, suffix.data(), suffix.size()) == 0) {
+                    SetMatch(match, IndicatorType::Domain, it->feed);
+                    return true;
+                }
+            }
+        }
+        start += dot + 1;
+    }
+    return false;
+}
+
+bool ThreatIntelDB::LookupHash(std::string_view hexDigest, Match* match) const {
+    uint8_t digest[32];
+    const int kind = header_ ? ParseDigest(hexDigest, digest) : -1;
+    return kind >= 0 && FindDigest(kind, digest, match);
+}
+
+bool ThreatIntelDB::FindDigest(int kind, const uint8_t* digest, Match* match) const {
+    const size_t length = kDigestLengths[kind];
+    if (!BloomMayContain(bloom_, bloomBlocks_, DigestKey(digest, length))) {
+        return false;
+    }
+
+    // Records are the digest followed by a 16-bit feed id, sorted by digest
+    const size_t stride = length + sizeof(uint16_t);
+    const uint8_t* records = digests_[kind];
+    size_t low = 0;
+    size_t high = static_cast<size_t>(header_->sections[SectionMd5 + kind].count);
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        const int order = std::memcmp(records + mid * stride, digest, length);
+        if (order == 0) {
+            uint16_t feed;
+            std::memcpy(&feed, records + mid * stride + length, sizeof(feed));
+            SetMatch(match, IndicatorType::FileHash, feed);
+            return true;
+        }
+        if (order < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return false;
+}
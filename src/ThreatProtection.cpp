@@ -15,7 +15,8 @@ bool ThreatProtection::Initialize() {
     // Initialize threat protection system
     activeThreats_.clear();
     threatHistory_.clear();
-    blockedIPs_.clear();
+    blockedIPs_.Clear();
+    blockedDomains_.Clear();
     
     return true;
 }
@@ -24,7 +25,8 @@ void ThreatProtection::Shutdown() {
     StopProtection();
     activeThreats_.clear();
     threatHistory_.clear();
-    blockedIPs_.clear();
+    blockedIPs_.Clear();
+    blockedDomains_.Clear();
 }
 
 bool ThreatProtection::StartProtection() {
@@ -79,16 +81,55 @@ ThreatProtection::ProtectionLevel ThreatProtection::GetProtectionLevel() const {
     return protectionLevel_;
 }
 
+void ThreatProtection::BlockIP(const IPAddress& ip, int prefixLength) {
+    blockedIPs_.Insert(ip, prefixLength < 0 ? (ip.IsIPv4() ? 32 : 128) : prefixLength);
+}
+
 void ThreatProtection::BlockIP(const std::string& ip) {
-    blockedIPs_.insert(ip);
+    blockedIPs_.Insert(ip);
+}
+
+void ThreatProtection::UnblockIP(const IPAddress& ip, int prefixLength) {
+    blockedIPs_.Remove(ip, prefixLength < 0 ? (ip.IsIPv4() ? 32 : 128) : prefixLength);
 }
 
 void ThreatProtection::UnblockIP(const std::string& ip) {
-    blockedIPs_.erase(ip);
+    blockedIPs_.Remove(ip);
+}
+
+bool ThreatProtection::IsIPBlocked(const IPAddress& ip) const {
+    return blockedIPs_.Contains(ip);
+}
+
+bool ThreatProtection::IsIPBlocked(const std::string& ip) const {
+    IPAddress address;
+    return IPAddress::Parse(ip, address) && IsIPBlocked(address);
 }
 
 std::vector<std::string> ThreatProtection::GetBlockedIPs() const {
-    return std::vector<std::string>(blockedIPs_.begin(), blockedIPs_.end());
+    auto prefixes = blockedIPs_.GetPrefixes();
+    std::vector<std::string> result;
+    result.reserve(prefixes.size());
+    for (const auto& prefix : prefixes) {
+        result.push_back(prefix.ToString());
+    }
+    return result;
+}
+
+void ThreatProtection::BlockDomain(const std::string& domain) {
+    blockedDomains_.Insert(domain);
+}
+
+void ThreatProtection::UnblockDomain(const std::string& domain) {
+    blockedDomains_.Remove(domain);
+}
+
+bool ThreatProtection::IsDomainBlocked(const std::string& hostname) const {
+    return blockedDomains_.Contains(hostname);
+}
+
+std::vector<std::string> ThreatProtection::GetBlockedDomains() const {
+    return blockedDomains_.GetRules();
 }
 
 bool ThreatProtection::IsProtectionActive() const {
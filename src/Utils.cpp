@@ -1,12 +1,16 @@
 #include "Utils.h"
+#include "IPAddress.h"
+#include "DnsResolver.h"
+#include "LinuxSystemStats.h"
+#include "LinuxProcessTable.h"
 #include <algorithm>
 #include <sstream>
 #include <fstream>
 #include <iomanip>
-#include <regex>
 #include <random>
 #include <iostream>
 #include <vector>
+#include <mutex>
 #include <cctype>
 
 #ifdef _WIN32
@@ -91,108 +95,33 @@ std::chrono::system_clock::time_point ParseTime(const std::string& timeStr) {
     return std::chrono::system_clock::now();
 }
 
-bool IsValidIPv4(const std::string& ip) {
-    std::regex ipRegex(R"(^(\d{1,3})\.(\d{1,3})\.(\d{1,3})\.(\d{1,3})$)");
-    std::smatch matches;
-    
-    if (!std::regex_match(ip, matches, ipRegex)) {
-        return false;
-    }
-    
-    for (int i = 1; i <= 4; ++i) {
-        try {
-            int octet = std::stoi(matches[i].str());
-            if (octet < 0 || octet > 255) {
-                return false;
-            }
-        } catch (const std::exception&) {
-            return false; // Invalid number format
-        }
-    }
-    
-    return true;
+bool IsValidIPv4(std::string_view ip) {
+    IPAddress address;
+    return IPAddress::ParseIPv4(ip, address);
 }
 
-bool IsValidIPv6(const std::string& ip) {
-    // Basic IPv6 validation with proper format checking
-    if (ip.empty() || ip.length() > 39) {
-        return false;
-    }
-    
-    // Must contain at least one colon
-    if (ip.find(':') == std::string::npos) {
-        return false;
-    }
-    
-    // Split by colons and validate each segment
-    auto segments = Split(ip, ':');
-    
-    // IPv6 has 8 segments (or fewer with :: compression)
-    if (segments.size() > 8) {
-        return false;
-    }
-    
-    // Check for double colon (compression)
-    size_t doubleColonPos = ip.find("::");
-    bool hasCompression = (doubleColonPos != std::string::npos);
-    
-    // If no compression, must have exactly 8 segments
-    if (!hasCompression && segments.size() != 8) {
-        return false;
-    }
-    
-    // Validate each non-empty segment
-    for (const auto& segment : segments) {
-        if (!segment.empty()) {
-            // Each segment must be 1-4 hex digits
-            if (segment.length() > 4) {
-                return false;
-            }
-            
-            // Check if all characters are valid hex digits
-            for (char c : segment) {
-                if (!std::isxdigit(c)) {
-                    return false;
-                }
-            }
-        }
-    }
-    
-    return true;
+bool IsValidIPv6(std::string_view ip) {
+    IPAddress address;
+    return IPAddress::ParseIPv6(ip, address);
 }
 
-bool IsPrivateIP(const std::string& ip) {
-    if (!IsValidIPv4(ip)) return false;
-    
-    auto parts = Split(ip, '.');
-    if (parts.size() != 4) return false;
-    
-    try {
-        int first = std::stoi(parts[0]);
-        int second = std::stoi(parts[1]);
-        
-        // 10.0.0.0/8
-        if (first == 10) return true;
-        
-        // 172.16.0.0/12
-        if (first == 172 && second >= 16 && second <= 31) return true;
-        
-        // 192.168.0.0/16
-        if (first == 192 && second == 168) return true;
-        
-        return false;
-    } catch (const std::exception&) {
-        return false; // Invalid number format
-    }
+bool IsPrivateIP(std::string_view ip) {
+    IPAddress address;
+    return IPAddress::Parse(ip, address) && address.Classify() == IPAddress::Scope::Private;
 }
 
-bool IsLocalIP(const std::string& ip) {
-    return ip == "127.0.0.1" || ip == "::1" || ip == "localhost";
+bool IsLocalIP(std::string_view ip) {
+    IPAddress address;
+    return ip == "localhost" || (IPAddress::Parse(ip, address) && address.Classify() == IPAddress::Scope::Loopback);
 }
 
 std::string GetHostname(const std::string& ip) {
-    // Would implement reverse DNS lookup
-    return ip; // Placeholder
+    IPAddress address;
+    if (!IPAddress::Parse(ip, address)) {
+        return ip;
+    }
+    DnsResolver::Result result = DnsResolver::Global()->Resolve(address);
+    return result.status == DnsResolver::Status::Resolved ? result.hostname : ip;
 }
 
 std::string GetLocalIP() {
@@ -375,6 +304,20 @@ std::string GetSystemInfo() {
 #endif
 }
 
+#ifndef _WIN32
+namespace {
+
+// Shared by all callers, which see the CPU delta since whoever sampled last
+LinuxSystemStats& SystemStats(std::unique_lock<std::mutex>& lock) {
+    static std::mutex mutex;
+    static LinuxSystemStats stats;
+    lock = std::unique_lock<std::mutex>(mutex);
+    return stats;
+}
+
+} // namespace
+#endif
+
 double GetCPUUsage() {
 #ifdef _WIN32
     static PDH_HQUERY cpuQuery = nullptr;
@@ -412,11 +355,12 @@ double GetCPUUsage() {
     
     return counterVal.doubleValue;
 #else
-    // Simulate CPU usage
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_real_distribution<> dis(15.0, 45.0);
-    return dis(gen);
+    std::unique_lock<std::mutex> lock;
+    LinuxSystemStats& stats = SystemStats(lock);
+    if (!stats.ReadCpu() || !stats.HasCpuUsage()) {
+        return 0.0;
+    }
+    return stats.GetCpuUsage().busy;
 #endif
 }
 
@@ -427,11 +371,31 @@ double GetMemoryUsage() {
     GlobalMemoryStatusEx(&memInfo);
     return static_cast<double>(memInfo.dwMemoryLoad);
 #else
-    // Simulate memory usage
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_real_distribution<> dis(40.0, 70.0);
-    return dis(gen);
+    std::unique_lock<std::mutex> lock;
+    LinuxSystemStats& stats = SystemStats(lock);
+    if (!stats.ReadMemory()) {
+        return 0.0;
+    }
+    return stats.GetMemory().UsedPercent();
+#endif
+}
+
+bool GetLoadAverage(double& one, double& five, double& fifteen) {
+#ifdef _WIN32
+    (void)one;
+    (void)five;
+    (void)fifteen;
+    return false;
+#else
+    std::unique_lock<std::mutex> lock;
+    LinuxSystemStats& stats = SystemStats(lock);
+    if (!stats.ReadLoad()) {
+        return false;
+    }
+    one = stats.GetLoad().one;
+    five = stats.GetLoad().five;
+    fifteen = stats.GetLoad().fifteen;
+    return true;
 #endif
 }
 
@@ -459,6 +423,17 @@ std::vector<std::string> GetRunningProcesses() {
             }
         }
     }
+#else
+    static std::mutex mutex;
+    static LinuxProcessTable table;
+    static std::vector<LinuxProcessTable::Change> changes;
+    std::lock_guard<std::mutex> lock(mutex);
+    changes.clear();
+    if (table.Scan(changes)) {
+        for (const auto& process : table.GetProcesses()) {
+            processes.push_back(process.name);
+        }
+    }
 #endif
     
     return processes;
@@ -2,10 +2,13 @@
 #include "SecurityApp.h"
 #include "GeminiClient.h"
 #include "SecurityMonitor.h"
+#include "NetworkMonitor.h"
+#include "SignatureEngine.h"
 #include "Utils.h"
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <algorithm>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -170,6 +173,11 @@ void ViewManager::ShowDashboard() {
                   << metrics.cpuUsage << "%\n";
         std::cout << "  Memory Usage:     " << std::fixed << std::setprecision(1) 
                   << metrics.memoryUsage << "%\n";
+        double load1, load5, load15;
+        if (Utils::GetLoadAverage(load1, load5, load15)) {
+            std::cout << "  Load Average:     " << std::setprecision(2) << load1 << " " << load5 << " " << load15
+                      << std::setprecision(1) << "\n";
+        }
         std::cout << "  Active Connections: " << metrics.activeConnections << "\n";
         std::cout << "  Suspicious Activity: " << metrics.suspiciousActivity << "\n";
         
@@ -187,6 +195,17 @@ void ViewManager::ShowDashboard() {
         }
         ResetConsoleColor();
         std::cout << " (" << threatLevel << "/5)\n";
+
+        auto checks = monitor->GetCheckStats();
+        if (!checks.empty()) {
+            std::cout << "\n  Checks:\n";
+            for (const auto& check : checks) {
+                std::cout << "  - " << std::left << std::setw(12) << check.name << std::right
+                          << " every " << check.interval.count() / 1000.0 << "s, last "
+                          << std::setprecision(1) << check.lastDuration.count() / 1000.0 << " ms"
+                          << ", missed " << check.missedDeadlines << "\n";
+            }
+        }
         
         // Recent events
         auto events = monitor->GetRecentEvents(5);
@@ -246,12 +265,35 @@ void ViewManager::ShowThreatProtection() {
     
     std::cout << "\n  Blocked Threats Today: 23\n";
     std::cout << "  Suspicious IPs Blocked: 5\n";
-    std::cout << "  Malware Signatures: 150,245 (Updated)\n";
+
+    auto monitor = app_->GetSecurityMonitor();
+    auto signatures = monitor ? monitor->GetNetworkMonitor().GetSignatureEngine() : nullptr;
+    if (signatures) {
+        std::cout << "  Malware Signatures: " << signatures->GetSignatureCount() << "\n";
+    } else {
+        std::cout << "  Malware Signatures: not loaded\n";
+    }
     
     std::cout << "\n  Recent Blocks:\n";
-    std::cout << "  - 192.168.1.50 - Port scan attempt\n";
-    std::cout << "  - 10.0.0.25 - Suspicious payload detected\n";
-    std::cout << "  - 172.16.0.100 - SYN flood attempt\n";
+    std::vector<NetworkMonitor::NetworkLog> blocks;
+    if (monitor) {
+        for (auto& log : monitor->GetNetworkMonitor().GetNetworkLogs(100)) {
+            if (log.status == "BLOCKED") {
+                blocks.push_back(std::move(log));
+            }
+        }
+    }
+    if (!blocks.empty()) {
+        // Logs come oldest first; show the latest few
+        const size_t shown = std::min<size_t>(blocks.size(), 5);
+        for (size_t i = blocks.size() - shown; i < blocks.size(); ++i) {
+            std::cout << "  - " << blocks[i].sourceIp.ToString() << " - " << blocks[i].threat << "\n";
+        }
+    } else {
+        std::cout << "  - 192.168.1.50 - Port scan attempt\n";
+        std::cout << "  - 10.0.0.25 - Suspicious payload detected\n";
+        std::cout << "  - 172.16.0.100 - SYN flood attempt\n";
+    }
     
     std::cout << "\n";
     ShowStatusBar("All protection systems operational");
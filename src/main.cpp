@@ -1,9 +1,477 @@
 #include "SecurityApp.h"
+#include "PcapReplay.h"
+#include "SignatureEngine.h"
 #include "Utils.h"
+#include "IPAddress.h"
+#include "LinuxSystemStats.h"
+#include "LinuxProcessTable.h"
 #include <iostream>
+#include <iomanip>
 #include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <regex>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+
+namespace {
+
+// Offline mode: security-sentinel --replay <capture> [--paced] [--speed <x>]
+int RunReplay(int argc, char* argv[]) {
+    std::string path;
+    PcapReplay::Options options;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            path = argv[++i];
+        } else if (std::strcmp(argv[i], "--paced") == 0) {
+            options.paced = true;
+        } else if (std::strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            options.speed = std::atof(argv[++i]);
+        }
+    }
+    if (path.empty()) {
+        std::cerr << "Usage: " << argv[0] << " --replay <capture.pcap|pcapng> [--paced] [--speed <x>]" << std::endl;
+        return 1;
+    }
+
+    // Threat-intel lookups use the same [threat_intel] settings as the interactive app
+    NetworkMonitor monitor;
+    Utils::Config::Instance().Load();
+    SecurityApp::ConfigureThreatIntel(monitor);
+    SecurityApp::ConfigureSignatures(monitor);
+    monitor.UpdateThreatDatabase();
+
+    PcapReplay replay(monitor);
+    PcapReplay::Report report;
+    bool ok = replay.Run(path, options, report);
+
+    std::cout << "Replay: " << report.ToString() << std::endl;
+    std::cout << "Suspicious sources: " << monitor.GetSuspiciousIPs().size()
+              << ", alerts logged: " << monitor.GetNetworkLogs(1000000).size() << std::endl;
+    for (const auto& log : monitor.GetNetworkLogs(20)) {
+        std::cout << "  " << log.sourceIp.ToString() << " -> " << log.destinationIp.ToString()
+                  << " " << log.protocol << " " << log.threat << std::endl;
+    }
+    if (!ok) {
+        std::cerr << "Replay stopped: " << replay.GetError() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Benchmark mode: security-sentinel --benchmark-signatures [count] [megabytes]
+// Random signatures of 8-32 bytes, half binary and half printable ASCII,
+// scanned over random bytes and over word-like text, with a hit planted
+// every 64 KB.
+int RunSignatureBenchmark(int argc, char* argv[]) {
+    size_t count = 150000;
+    size_t megabytes = 64;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--benchmark-signatures") == 0) {
+            if (i + 1 < argc && argv[i + 1][0] != '-') count = std::strtoul(argv[++i], nullptr, 10);
+            if (i + 1 < argc && argv[i + 1][0] != '-') megabytes = std::strtoul(argv[++i], nullptr, 10);
+        }
+    }
+    megabytes = std::max<size_t>(megabytes, 1);
+
+    using BenchClock = std::chrono::steady_clock;
+    std::mt19937_64 random(42);
+    auto printable = [&]() { return static_cast<char>(' ' + random() % 95); };
+
+    SignatureEngine engine;
+    std::vector<std::string> signatures;
+    signatures.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        std::string bytes(8 + random() % 25, '\0');
+        for (char& c : bytes) {
+            c = i % 2 ? printable() : static_cast<char>(random());
+        }
+        engine.AddSignature("Bench.Signature." + std::to_string(i), bytes);
+        signatures.push_back(std::move(bytes));
+    }
+    auto start = BenchClock::now();
+    engine.Compile();
+    const double compileMs = std::chrono::duration<double, std::milli>(BenchClock::now() - start).count();
+    std::cout << "Signatures: " << engine.GetSignatureCount() << ", states: " << engine.GetStateCount()
+              << ", memory: " << engine.GetMemoryUsage() / (1024 * 1024) << " MB, stride: " << engine.GetStride()
+              << ", compile: " << std::fixed << std::setprecision(0) << compileMs << " ms" << std::endl;
+
+    const size_t size = megabytes * 1024 * 1024;
+    std::vector<uint8_t> binary(size);
+    std::vector<uint8_t> text(size);
+    for (size_t i = 0; i < size; ++i) {
+        binary[i] = static_cast<uint8_t>(random());
+    }
+    for (size_t i = 0; i < size;) {
+        // lower-case words of 1-10 letters, then a space, newline or comma
+        for (size_t letters = 1 + random() % 10; letters && i < size; --letters) {
+            text[i++] = static_cast<uint8_t>('a' + random() % 26);
+        }
+        if (i < size) {
+            const uint64_t separator = random() % 16;
+            text[i++] = separator == 0 ? '\n' : separator == 1 ? ',' : ' ';
+        }
+    }
+    for (size_t at = 4096; at + 64 < size; at += 65536) {
+        const std::string& planted = signatures[random() % count];
+        std::memcpy(binary.data() + at, planted.data(), planted.size());
+        std::memcpy(text.data() + at, planted.data(), planted.size());
+    }
+
+    struct Input {
+        const char* name;
+        const std::vector<uint8_t>* data;
+    };
+    const Input inputs[] = {{"binary", &binary}, {"text", &text}};
+    const SignatureEngine::Prefilter kernels[] = {SignatureEngine::Prefilter::Scalar, SignatureEngine::Prefilter::Avx2};
+    const size_t chunkSizes[] = {0, 1460};  // whole buffer, packet-sized stream
+
+    for (const Input& input : inputs) {
+        for (auto kernel : kernels) {
+            engine.SetPrefilter(kernel);
+            if (engine.GetPrefilter() != kernel) {
+                continue;
+            }
+            for (size_t chunk : chunkSizes) {
+                uint64_t matches = 0;
+                SignatureEngine::Stream stream;
+                start = BenchClock::now();
+                const size_t step = chunk ? chunk : size;
+                for (size_t offset = 0; offset < size; offset += step) {
+                    engine.Scan(stream, input.data->data() + offset, std::min(step, size - offset),
+                                [&matches](const SignatureEngine::Match&) { matches++; });
+                }
+                const double seconds = std::chrono::duration<double>(BenchClock::now() - start).count();
+                std::cout << "  " << std::setw(6) << input.name << "  "
+                          << (kernel == SignatureEngine::Prefilter::Avx2 ? "avx2  " : "scalar") << "  "
+                          << (chunk ? "1460-byte chunks" : "single buffer   ") << "  " << std::setprecision(2)
+                          << size / seconds / 1e9 << " GB/s, " << matches << " matches" << std::endl;
+            }
+        }
+    }
+    return 0;
+}
+
+// The Utils address checks as they were before IPAddress backed them
+// (regex per call, Split and stoi); kept as the --benchmark-ip baseline.
+std::vector<std::string> LegacySplit(const std::string& str, char delimiter) {
+    std::vector<std::string> tokens;
+    std::stringstream ss(str);
+    std::string token;
+    while (std::getline(ss, token, delimiter)) {
+        tokens.push_back(token);
+    }
+    return tokens;
+}
+
+bool LegacyIsValidIPv4(const std::string& ip) {
+    std::regex ipRegex(R"(^(\d{1,3})\.(\d{1,3})\.(\d{1,3})\.(\d{1,3})$)");
+    std::smatch matches;
+    if (!std::regex_match(ip, matches, ipRegex)) {
+        return false;
+    }
+    for (int i = 1; i <= 4; ++i) {
+        try {
+            if (std::stoi(matches[i].str()) > 255) {
+                return false;
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool LegacyIsValidIPv6(const std::string& ip) {
+    if (ip.empty() || ip.length() > 39 || ip.find(':') == std::string::npos) {
+        return false;
+    }
+    auto segments = LegacySplit(ip, ':');
+    if (segments.size() > 8) {
+        return false;
+    }
+    if (ip.find("::") == std::string::npos && segments.size() != 8) {
+        return false;
+    }
+    for (const auto& segment : segments) {
+        if (segment.length() > 4) {
+            return false;
+        }
+        for (char c : segment) {
+            if (!std::isxdigit(static_cast<unsigned char>(c))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool LegacyIsPrivateIP(const std::string& ip) {
+    if (!LegacyIsValidIPv4(ip)) return false;
+    auto parts = LegacySplit(ip, '.');
+    if (parts.size() != 4) return false;
+    try {
+        int first = std::stoi(parts[0]);
+        int second = std::stoi(parts[1]);
+        return first == 10 || (first == 172 && second >= 16 && second <= 31) || (first == 192 && second == 168);
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+// Mixed public/private IPv4, IPv6 and non-address strings, as found in logs
+int RunAddressBenchmark(int argc, char* argv[]) {
+    size_t count = 200000;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--benchmark-ip") == 0 && i + 1 < argc && argv[i + 1][0] != '-') {
+            count = std::strtoul(argv[++i], nullptr, 10);
+        }
+    }
+    count = std::max<size_t>(count, 1);
+
+    std::mt19937_64 random(42);
+    const char* const names[] = {"localhost", "example.com", "300.1.2.3", "1.2.3", "10.0.0.256", "::g", "fe80::1::2"};
+    std::vector<std::string> inputs;
+    inputs.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const uint64_t kind = random() % 10;
+        if (kind < 5) {
+            uint32_t v4 = static_cast<uint32_t>(random());
+            if (kind < 2) {
+                v4 = (kind == 0 ? 0x0A000000u : 0xC0A80000u) | (v4 & 0xFFFF);
+            }
+            inputs.push_back(IPAddress::FromIPv4(v4).ToString());
+        } else if (kind < 8) {
+            uint8_t bytes[16] = {0x20, 0x01, 0x0d, 0xb8};
+            for (int b = 4; b < 16; ++b) {
+                bytes[b] = random() % 3 ? 0 : static_cast<uint8_t>(random());
+            }
+            if (kind == 7) {
+                bytes[0] = 0xfd;
+            }
+            inputs.push_back(IPAddress::FromIPv6Bytes(bytes).ToString());
+        } else {
+            inputs.push_back(names[random() % (sizeof(names) / sizeof(names[0]))]);
+        }
+    }
+
+    struct Case {
+        const char* name;
+        bool (*legacy)(const std::string&);
+        bool (*current)(std::string_view);
+    };
+    const Case cases[] = {
+        {"IsValidIPv4", LegacyIsValidIPv4, Utils::IsValidIPv4},
+        {"IsValidIPv6", LegacyIsValidIPv6, Utils::IsValidIPv6},
+        {"IsPrivateIP", LegacyIsPrivateIP, Utils::IsPrivateIP},
+    };
+
+    using BenchClock = std::chrono::steady_clock;
+    auto nanosPerCall = [count](BenchClock::time_point start) {
+        return std::chrono::duration<double, std::nano>(BenchClock::now() - start).count() / count;
+    };
+    std::cout << count << " inputs" << std::fixed << std::setprecision(1) << std::endl;
+    for (const Case& c : cases) {
+        size_t legacyHits = 0;
+        auto start = BenchClock::now();
+        for (const auto& input : inputs) legacyHits += c.legacy(input);
+        const double legacyNs = nanosPerCall(start);
+
+        // Repeat the fast path so the clock resolution does not dominate
+        const int repeats = 20;
+        size_t hits = 0;
+        start = BenchClock::now();
+        for (int r = 0; r < repeats; ++r) {
+            for (const auto& input : inputs) hits += c.current(input);
+        }
+        const double currentNs = nanosPerCall(start) / repeats;
+
+        std::cout << "  " << std::left << std::setw(12) << c.name << std::right << "  regex/split "
+                  << std::setw(8) << legacyNs << " ns  (" << legacyHits << " true)   now " << std::setw(6)
+                  << currentNs << " ns  (" << hits / repeats << " true)   " << legacyNs / currentNs << "x"
+                  << std::endl;
+    }
+
+    size_t scopes[static_cast<size_t>(IPAddress::Scope::Reserved) + 1] = {};
+    auto start = BenchClock::now();
+    for (const auto& input : inputs) {
+        IPAddress address;
+        if (IPAddress::Parse(input, address)) {
+            scopes[static_cast<size_t>(address.Classify())]++;
+        }
+    }
+    std::cout << "  Parse+Classify " << nanosPerCall(start) << " ns:";
+    for (size_t i = 0; i < sizeof(scopes) / sizeof(scopes[0]); ++i) {
+        if (scopes[i]) std::cout << " " << IPAddress::GetScopeName(static_cast<IPAddress::Scope>(i)) << "=" << scopes[i];
+    }
+    std::cout << std::endl;
+    return 0;
+}
+
+// The usual way of reading the same three files: reopen each one and parse
+// lines through string streams. Kept as the --benchmark-sysstats baseline.
+bool LegacySample(const std::string& procRoot, double& cpuJiffies, double& memoryTotal, double& load) {
+    std::ifstream stat(procRoot + "/stat");
+    std::string line;
+    if (!std::getline(stat, line)) {
+        return false;
+    }
+    std::istringstream cpu(line.substr(3));
+    cpuJiffies = 0;
+    for (double value; cpu >> value;) {
+        cpuJiffies += value;
+    }
+
+    std::ifstream meminfo(procRoot + "/meminfo");
+    while (std::getline(meminfo, line)) {
+        std::istringstream fields(line);
+        std::string key;
+        fields >> key >> memoryTotal;
+        if (key == "MemTotal:") {
+            break;
+        }
+    }
+
+    std::ifstream loadavg(procRoot + "/loadavg");
+    return static_cast<bool>(loadavg >> load);
+}
+
+// Benchmark mode: security-sentinel --benchmark-sysstats [samples] [proc root]
+// A fixture directory holding stat, meminfo and loadavg works as the root.
+int RunSystemStatsBenchmark(int argc, char* argv[]) {
+    size_t samples = 20000;
+    std::string procRoot = "/proc";
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--benchmark-sysstats") == 0) {
+            if (i + 1 < argc && argv[i + 1][0] != '-') samples = std::strtoul(argv[++i], nullptr, 10);
+            if (i + 1 < argc && argv[i + 1][0] != '-') procRoot = argv[++i];
+        }
+    }
+    samples = std::max<size_t>(samples, 2);
+
+    LinuxSystemStats stats(procRoot);
+    if (!stats.Sample()) {
+        std::cerr << "Cannot read stat, meminfo and loadavg under " << procRoot << std::endl;
+        return 1;
+    }
+
+    // Process CPU time includes the kernel's work generating the files
+    auto report = [samples](const char* name, std::clock_t cpuStart, std::chrono::steady_clock::time_point wallStart) {
+        const double cpuMicros = 1e6 * static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC / samples;
+        const double wallMicros = std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - wallStart).count() / samples;
+        std::cout << "  " << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(2)
+                  << wallMicros << " us/sample wall, " << cpuMicros << " us CPU, "
+                  << std::setprecision(4) << cpuMicros * 10 / 1e4 << "% of a core at 10 Hz" << std::endl;
+    };
+
+    std::cout << "System stats benchmark: " << samples << " samples of " << procRoot << std::endl;
+    std::clock_t cpuStart = std::clock();
+    auto wallStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < samples; ++i) {
+        stats.Sample();
+    }
+    report("pread", cpuStart, wallStart);
+
+    double jiffies = 0;
+    double memoryTotal = 0;
+    double load = 0;
+    cpuStart = std::clock();
+    wallStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < samples; ++i) {
+        LegacySample(procRoot, jiffies, memoryTotal, load);
+    }
+    report("ifstream", cpuStart, wallStart);
+
+    const auto& cpu = stats.GetCpuUsage();
+    const auto& memory = stats.GetMemory();
+    const auto& loads = stats.GetLoad();
+    std::cout << std::setprecision(1) << "  CPU " << cpu.busy << "% busy (user " << cpu.user << ", system " << cpu.system
+              << ", iowait " << cpu.iowait << ", steal " << cpu.steal << ") over " << stats.GetPerCpuUsage().size() << " CPUs:";
+    for (const auto& usage : stats.GetPerCpuUsage()) {
+        std::cout << " " << usage.busy;
+    }
+    std::cout << "\n  Memory " << memory.UsedPercent() << "% used of " << memory.totalKb / 1024 << " MB, load "
+              << std::setprecision(2) << loads.one << " " << loads.five << " " << loads.fifteen
+              << " (" << loads.runnable << "/" << loads.total << " tasks)" << std::endl;
+    return 0;
+}
+
+// Benchmark mode: security-sentinel --benchmark-proc [proc root] [scans]
+// Times a cold scan (every process read in full) and steady-state rescans,
+// single-threaded and across all cores.
+int RunProcessBenchmark(int argc, char* argv[]) {
+    std::string procRoot = "/proc";
+    size_t scans = 20;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--benchmark-proc") == 0) {
+            if (i + 1 < argc && argv[i + 1][0] != '-') procRoot = argv[++i];
+            if (i + 1 < argc && argv[i + 1][0] != '-') scans = std::strtoul(argv[++i], nullptr, 10);
+        }
+    }
+    scans = std::max<size_t>(scans, 1);
+
+    auto millisSince = [](std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::cout << "Process scan benchmark: " << procRoot << std::endl;
+    const size_t threadCounts[] = {1, 0};
+    for (size_t threads : threadCounts) {
+        LinuxProcessTable table(procRoot, threads);
+        std::vector<LinuxProcessTable::Change> changes;
+        auto start = std::chrono::steady_clock::now();
+        if (!table.Scan(changes)) {
+            std::cerr << "Cannot read " << procRoot << std::endl;
+            return 1;
+        }
+        const double cold = millisSince(start);
+
+        // Past the young-process window, rescans reach their steady state
+        for (uint64_t i = 0; i < LinuxProcessTable::kYoungScans; ++i) {
+            table.Scan(changes);
+        }
+        size_t changed = 0;
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < scans; ++i) {
+            changes.clear();
+            table.Scan(changes);
+            changed += changes.size();
+        }
+        const double warm = millisSince(start) / scans;
+
+        std::cout << "  " << (threads ? "1 thread:   " : "all cores:  ") << table.Size() << " processes, cold scan "
+                  << std::fixed << std::setprecision(2) << cold << " ms, rescan " << warm << " ms ("
+                  << changed / scans << " changes per rescan)" << std::endl;
+    }
+    return 0;
+}
+
+} // namespace
 
 int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--replay") == 0) {
+            return RunReplay(argc, argv);
+        }
+        if (std::strcmp(argv[i], "--benchmark-signatures") == 0) {
+            return RunSignatureBenchmark(argc, argv);
+        }
+        if (std::strcmp(argv[i], "--benchmark-ip") == 0) {
+            return RunAddressBenchmark(argc, argv);
+        }
+        if (std::strcmp(argv[i], "--benchmark-sysstats") == 0) {
+            return RunSystemStatsBenchmark(argc, argv);
+        }
+        if (std::strcmp(argv[i], "--benchmark-proc") == 0) {
+            return RunProcessBenchmark(argc, argv);
+        }
+    }
+
     try {
         // Set console title and properties
         Utils::SetConsoleTitle("Security Sentinel");